@@ -47,6 +47,7 @@ constexpr inline std::string_view convert_abi_error(eosio::abi_error e) {
 }
 
 struct abi_serializer;
+struct fd_stream;
 
 template <typename T>
 struct might_not_exist {
@@ -188,6 +189,20 @@ EOSIO_REFLECT(abi_def, version, types, structs, actions, tables, ricardian_claus
 
 struct abi_type;
 
+/// Result of converting a batch of json documents of one type. `bin` holds the binary of each document
+/// that converted, preceded by its size as a varuint32. `items` has one entry per input document.
+struct json_to_bin_batch_result {
+   struct item {
+      size_t      offset = 0; // position in bin, after the size prefix
+      size_t      size   = 0;
+      std::string error;      // empty if the document converted
+   };
+
+   std::vector<char> bin;
+   std::vector<item> items;
+   size_t            failed = 0;
+};
+
 struct abi_field {
    std::string     name;
    const abi_type* type;
@@ -273,6 +288,16 @@ struct abi_type {
 
    std::string bin_to_json(input_stream bin) const;
    std::vector<char> json_to_bin(std::string_view json) const;
+
+   // Writes the json to out a page at a time instead of building it in memory
+   void bin_to_json(input_stream bin, fd_stream& out) const;
+
+   // Convert many documents, reusing one tokenizer and output buffer. A document that fails to
+   // convert is recorded in its item and does not stop the batch.
+   void json_to_bin_batch(json_to_bin_batch_result& result, const std::string_view* json, size_t count) const;
+
+   // Same as json_to_bin_batch, with one document per line. Empty lines are skipped.
+   void json_to_bin_ndjson(json_to_bin_batch_result& result, std::string_view ndjson) const;
 };
 
 struct abi {
@@ -80,6 +80,20 @@ abieos_bool abieos_json_to_bin(abieos_context* context, uint64_t contract, const
 abieos_bool abieos_json_to_bin_reorderable(abieos_context* context, uint64_t contract, const char* type,
                                            const char* json);
 
+// Convert a batch of json documents of the same type, one per line of ndjson. Empty lines are skipped. A document that
+// fails to convert does not stop the batch. Use abieos_get_bin_* to retrieve the converted documents, each preceded by
+// its size as a varuint32, and abieos_get_batch_item to locate them. Returns the number of documents, or -1 on error.
+int abieos_json_to_bin_ndjson(abieos_context* context, uint64_t contract, const char* type, const char* ndjson,
+                              size_t size);
+
+// Same as abieos_json_to_bin_ndjson, with the documents given as an array of strings and their sizes.
+int abieos_json_to_bin_batch(abieos_context* context, uint64_t contract, const char* type, const char* const* json,
+                             const size_t* sizes, size_t count);
+
+// Locate document `index` of the last batch within abieos_get_bin_data. Returns false if the document failed to
+// convert; use abieos_get_error to retrieve its error.
+abieos_bool abieos_get_batch_item(abieos_context* context, size_t index, size_t* offset, size_t* size);
+
 // Convert binary to json. The context owns the returned string. Returns null on error; use abieos_get_error to retrieve
 // error.
 const char* abieos_bin_to_json(abieos_context* context, uint64_t contract, const char* type, const char* data,
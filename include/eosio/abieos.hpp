@@ -27,6 +27,7 @@
 #endif
 
 #include <ctime>
+#include <deque>
 #include <map>
 #include <optional>
 #include <variant>
@@ -224,6 +225,13 @@ struct json_to_bin_stack_entry {
     size_t variant_type_index = 0;
 };
 
+// A field that arrived ahead of its turn, kept as the tokens of its value
+struct json_to_bin_deferred_field {
+    size_t depth = 0; // stack size while its object is on top
+    int field = 0;
+    eosio::json_token_stream::token_range tokens{};
+};
+
 struct bin_to_json_stack_entry {
     const abi_type* type = nullptr;
     bool allow_extensions = false;
@@ -271,17 +279,27 @@ struct json_to_bin_state : eosio::json_token_stream {
     std::vector<json_to_bin_stack_entry> stack{};
     bool skipped_extension = false;
 
+    // Set to accept fields in any order. Fields that arrive early are deferred and replayed in order.
+    bool reorder = false;
+    // Set if a field was repeated after it was written; the caller must fall back to the jvalue path
+    bool reorder_failed = false;
+    std::vector<json_to_bin_deferred_field> deferred_fields{};
+
     explicit json_to_bin_state(char* in, eosio::vector_stream& out)
       : eosio::json_token_stream(in), writer(out) {}
+
+    json_to_bin_state(char* in, const eosio::json_structural_index* index, eosio::vector_stream& out)
+      : eosio::json_token_stream(in, index), writer(out) {}
 };
 
 struct bin_to_json_state {
     eosio::input_stream& bin;
-    eosio::vector_stream& writer;
+    eosio::segmented_stream& writer;
     std::vector<bin_to_json_stack_entry> stack{};
     bool skipped_extension = false;
+    eosio::name_json_cache* name_cache = nullptr;
 
-    bin_to_json_state(eosio::input_stream& bin, eosio::vector_stream& writer)
+    bin_to_json_state(eosio::input_stream& bin, eosio::segmented_stream& writer)
         : bin{bin}, writer{writer} {}
 };
 
@@ -421,6 +439,14 @@ using eosio::symbol;
 using eosio::asset;
 using eosio::extended_asset;
 
+inline void bin_to_json(name*, bin_to_json_state& state, bool, const abi_type*, bool start) {
+    name v;
+    from_bin(v, state.bin);
+    if (state.name_cache)
+        return state.name_cache->write(v.value, state.writer);
+    return to_json(v, state.writer);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // 128-bit support when native support is absent
 ///////////////////////////////////////////////////////////////////////////////
@@ -791,35 +817,360 @@ inline void json_to_bin(std::string*, State& state, bool, const abi_type*,
 // json_to_bin
 ///////////////////////////////////////////////////////////////////////////////
 
+// Converts any number of documents with one token stream, structural index and output buffer,
+// so allocations made for earlier documents are reused by later ones
+struct json_to_bin_converter {
+    std::string mutable_json;
+    std::vector<char> out_buf;
+    eosio::vector_stream out{out_buf};
+    eosio::json_structural_index index;
+    json_to_bin_state state{nullptr, nullptr, out};
+
+    // Accept fields in any order, with the same results as converting through a jvalue. Fields that
+    // arrive out of order are buffered as token ranges; well-ordered input costs the same as without.
+    bool reorder = false;
+
+    json_to_bin_converter() = default;
+    json_to_bin_converter(const json_to_bin_converter&) = delete;
+    json_to_bin_converter& operator=(const json_to_bin_converter&) = delete;
+
+    // Appends the binary form of json to bin. If size_prefix is set, the binary is preceded by its size as a
+    // varuint32, the same layout as an element of bytes[]. Returns the size of the binary, not counting the prefix.
+    // Throws on error; bin may then hold a partial result.
+    template<typename F>
+    size_t convert(std::vector<char>& bin, const abi_type* type, std::string_view json, bool size_prefix, F&& f) {
+        bool streamed = false;
+        if (!reorder) {
+            streamed = stream(type, json, f);
+        } else {
+            // The jvalue path decides the result whenever streaming can't: a field repeated after it
+            // was written, or any error, since a later duplicate may replace the value that failed
+            try {
+                streamed = stream(type, json, f);
+            } catch (std::exception&) {
+            }
+        }
+        if (!streamed) {
+            jvalue value;
+            json_to_jvalue(value, json, f);
+            out_buf.clear();
+            state.size_insertions.clear();
+            json_to_bin(out_buf, type, value, f);
+        }
+
+        if (size_prefix) {
+            eosio::size_stream size{out_buf.size()};
+            for (auto& insertion : state.size_insertions)
+                eosio::varuint32_to_bin(insertion.size, size);
+            eosio::check(size.size <= std::numeric_limits<uint32_t>::max(), "binary is too large for a size prefix");
+            eosio::push_varuint32(bin, size.size);
+        }
+        size_t start = bin.size();
+        size_t pos = 0;
+        for (auto& insertion : state.size_insertions) {
+            bin.insert(bin.end(), out_buf.begin() + pos, out_buf.begin() + insertion.position);
+            eosio::push_varuint32(bin, insertion.size);
+            pos = insertion.position;
+        }
+        bin.insert(bin.end(), out_buf.begin() + pos, out_buf.end());
+        return bin.size() - start;
+    }
+
+  private:
+    // Converts json into out_buf and size_insertions. Returns false if reorder mode has to fall back.
+    template<typename F>
+    bool stream(const abi_type* type, std::string_view json, F&& f) {
+        mutable_json.assign(json);
+        mutable_json.append(3, 0);
+        out_buf.clear();
+        state.size_insertions.clear();
+        state.stack.clear();
+        state.skipped_extension = false;
+        state.reorder = reorder;
+        state.reorder_failed = false;
+        state.deferred_fields.clear();
+        bool indexed = json.size() < eosio::json_structural_index::max_size;
+        if (indexed)
+            index.build(mutable_json.data(), json.size());
+        state.reset(mutable_json.data(), indexed ? &index : nullptr);
+
+        type->get_serializer()->json_to_bin(state, true, type, true);
+        while(!state.stack.empty() && !state.reorder_failed) {
+            f();
+            auto entry = state.stack.back();
+            auto* type = entry.type;
+            eosio::check(state.stack.size() <= max_stack_size,
+                eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+            type->get_serializer()->json_to_bin(state, entry.allow_extensions, type, false);
+        }
+        if (state.reorder_failed)
+            return false;
+        eosio::check(state.complete(),
+            eosio::convert_json_error(eosio::from_json_error::expected_end));
+        return true;
+    }
+};
+
 template<typename F>
 inline void json_to_bin(std::vector<char>& bin, const abi_type* type, std::string_view json, F&& f) {
-    std::string mutable_json{json};
-    mutable_json.push_back(0);
-    mutable_json.push_back(0);
-    mutable_json.push_back(0);
+    json_to_bin_converter converter;
+    converter.convert(bin, type, json, false, f);
+}
+
+// Converts a json document that arrives in pieces, e.g. from a socket. Input is held only until the
+// tokens in it have been consumed, and binary is appended to bin as soon as it is final. The contents
+// of arrays that are still open are held back, since their size prefix comes first.
+//
+// The explicit stack lets conversion stop between any two steps. A step reads at most
+// max_tokens_per_step tokens, so a step only runs once that many complete tokens are buffered;
+// a token split across pieces waits for the rest. After an exception the parser can't be used.
+class json_to_bin_push_parser {
+  public:
+    static constexpr size_t max_tokens_per_step = 2;
+
+    json_to_bin_push_parser(std::vector<char>& bin, const abi_type* type) : bin(bin), type(type) {}
+
+    json_to_bin_push_parser(const json_to_bin_push_parser&) = delete;
+    json_to_bin_push_parser& operator=(const json_to_bin_push_parser&) = delete;
+
+    // Add the next piece of the document. Like json_to_bin, a NUL byte ends the input.
+    void feed(const char* data, size_t size) {
+        eosio::check(!finished, "json_to_bin_push_parser: feed after finish");
+        if (ended)
+            return;
+        if (auto nul = static_cast<const char*>(memchr(data, 0, size))) {
+            size = nul - data;
+            ended = true;
+        }
+        append(data, size);
+        scan(ended);
+        run(false);
+        if (started && state.stack.empty() && state.complete()) {
+            for (auto p = state.get_read_position(); *p; ++p)
+                eosio::check(*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r',
+                    eosio::convert_json_error(eosio::from_json_error::document_root_not_singular));
+        }
+        flush();
+    }
+
+    // Signal the end of the document and append the rest of the binary
+    void finish() {
+        eosio::check(!finished, "json_to_bin_push_parser: finish called twice");
+        finished = true;
+        scan(true);
+        run(true);
+        eosio::check(state.complete(),
+            eosio::convert_json_error(eosio::from_json_error::expected_end));
+        flush();
+    }
+
+  private:
+    enum class lex_state : uint8_t { between, in_string, in_escape, in_scalar };
+
+    std::vector<char>& bin;
+    const abi_type* type;
+    std::vector<char> text{0}; // unconsumed input, followed by a NUL
+    size_t discarded = 0;      // input bytes dropped from the front of text
+    size_t scan_pos = 0;
+    lex_state lex = lex_state::between;
+    std::deque<size_t> token_ends; // input offsets of complete tokens the reader hasn't reached
     std::vector<char> out_buf;
-    eosio::vector_stream out(out_buf);
-    json_to_bin_state state(mutable_json.data(), out);
+    eosio::vector_stream out{out_buf};
+    json_to_bin_state state{text.data(), out};
+    bool started = false;
+    bool ended = false;
+    bool finished = false;
+
+    // Appends to text, first dropping input that is no longer referenced
+    void append(const char* data, size_t size) {
+        const char* keep_ptr = state.get_read_position();
+        auto& token = state.current_token;
+        if (token.type == eosio::json_token_type::type_key)
+            keep_ptr = std::min(keep_ptr, token.key.data());
+        else if (token.type == eosio::json_token_type::type_string)
+            keep_ptr = std::min(keep_ptr, token.value_string.data());
+        size_t keep = keep_ptr - text.data();
+        size_t used = text.size() - 1;
+        size_t needed = used - keep + size + 1;
+        if (needed > text.capacity()) {
+            std::vector<char> bigger;
+            bigger.reserve(std::max(needed, text.capacity() * 2));
+            bigger.assign(text.begin() + keep, text.begin() + used);
+            state.rebase(text.data() + keep, bigger.data());
+            text.swap(bigger);
+        } else {
+            memmove(text.data(), text.data() + keep, used - keep);
+            state.rebase(text.data() + keep, text.data());
+            text.resize(used - keep);
+        }
+        text.insert(text.end(), data, data + size);
+        text.push_back(0);
+        discarded += keep;
+        scan_pos -= keep;
+    }
 
-    type->get_serializer()->json_to_bin(state, true, type, true);
-    while(!state.stack.empty()) {
-        f();
-        auto entry = state.stack.back();
-        auto* type = entry.type;
-        eosio::check(state.stack.size() <= max_stack_size,
-            eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
-        type->get_serializer()->json_to_bin(state, entry.allow_extensions, type, false);
+    // Finds the ends of the complete tokens in the new input. Delimiters (',' and ':') are read
+    // together with the token that follows them, so they aren't counted.
+    void scan(bool at_end) {
+        auto is_delimiter = [](char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',' || c == ':' || c == '{' ||
+                   c == '}' || c == '[' || c == ']' || c == '"';
+        };
+        const char* begin = text.data();
+        const char* end = begin + text.size() - 1;
+        const char* p = begin + scan_pos;
+        auto token_end = [&](const char* pos) { token_ends.push_back(discarded + (pos - begin)); };
+        while (p != end) {
+            char c = *p;
+            switch (lex) {
+            case lex_state::between:
+                ++p;
+                if (c == '{' || c == '}' || c == '[' || c == ']')
+                    token_end(p);
+                else if (c == '"')
+                    lex = lex_state::in_string;
+                else if (!is_delimiter(c))
+                    lex = lex_state::in_scalar;
+                break;
+            case lex_state::in_string:
+                ++p;
+                if (c == '\\')
+                    lex = lex_state::in_escape;
+                else if (c == '"') {
+                    token_end(p);
+                    lex = lex_state::between;
+                }
+                break;
+            case lex_state::in_escape:
+                ++p;
+                lex = lex_state::in_string;
+                break;
+            case lex_state::in_scalar:
+                if (is_delimiter(c)) {
+                    token_end(p);
+                    lex = lex_state::between;
+                } else {
+                    ++p;
+                }
+                break;
+            }
+        }
+        if (at_end && lex == lex_state::in_scalar) {
+            token_end(p);
+            lex = lex_state::between;
+        }
+        scan_pos = p - begin;
+    }
+
+    size_t available_tokens() {
+        size_t read = discarded + (state.get_read_position() - text.data());
+        while (!token_ends.empty() && token_ends.front() <= read)
+            token_ends.pop_front();
+        return token_ends.size();
+    }
+
+    void run(bool at_end) {
+        auto ready = [&] { return at_end || available_tokens() >= max_tokens_per_step; };
+        if (!started) {
+            if (!ready())
+                return;
+            started = true;
+            type->get_serializer()->json_to_bin(state, true, type, true);
+        }
+        while (!state.stack.empty() && ready()) {
+            auto entry = state.stack.back();
+            eosio::check(state.stack.size() <= max_stack_size,
+                eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+            entry.type->get_serializer()->json_to_bin(state, entry.allow_extensions, entry.type, false);
+        }
+    }
+
+    // Moves the binary that precedes the outermost open array (or all of it) to bin
+    void flush() {
+        size_t k = state.size_insertions.size();
+        for (auto& entry : state.stack) {
+            if (entry.type->array_of() || entry.type->szarray_of()) {
+                k = entry.size_insertion_index;
+                break;
+            }
+        }
+        size_t end = k < state.size_insertions.size() ? state.size_insertions[k].position : out_buf.size();
+        if (!k && !end)
+            return;
+        size_t pos = 0;
+        for (size_t i = 0; i < k; ++i) {
+            auto& insertion = state.size_insertions[i];
+            bin.insert(bin.end(), out_buf.begin() + pos, out_buf.begin() + insertion.position);
+            eosio::push_varuint32(bin, insertion.size);
+            pos = insertion.position;
+        }
+        bin.insert(bin.end(), out_buf.begin() + pos, out_buf.begin() + end);
+        out_buf.erase(out_buf.begin(), out_buf.begin() + end);
+        state.size_insertions.erase(state.size_insertions.begin(), state.size_insertions.begin() + k);
+        for (auto& insertion : state.size_insertions)
+            insertion.position -= end;
+        for (auto& entry : state.stack)
+            if (entry.type->array_of() || entry.type->szarray_of())
+                entry.size_insertion_index -= k;
+    }
+};
+
+// Handles a key or the end of an object in reorder mode when it differs from the in-order case: replays a
+// deferred field whose turn has come, and defers (or ignores, if unknown) a key that isn't next. Returns false
+// if the step should continue as in order.
+inline bool json_to_bin_reorder_step(json_to_bin_state& state, json_to_bin_stack_entry& stack_entry,
+                                     const std::vector<eosio::abi_field>& fields) {
+    auto& token = state.peek_token().get();
+    if (token.type != eosio::json_token_type::type_key && token.type != eosio::json_token_type::type_end_object)
+        return false;
+    auto depth = state.stack.size();
+    auto& deferred = state.deferred_fields;
+    for (auto it = deferred.end(); it != deferred.begin() && (it - 1)->depth == depth;) {
+        if ((--it)->field == stack_entry.position + 1) {
+            eosio::check(!state.skipped_extension,
+                eosio::convert_json_error(eosio::from_json_error::unexpected_field));
+            if (trace_json_to_bin)
+                printf("%*sreplay field %s\n", int(depth * 4), "", fields[it->field].name.c_str());
+            state.replay(it->tokens);
+            deferred.erase(it);
+            ++stack_entry.position;
+            return true;
+        }
+    }
+    if (token.type == eosio::json_token_type::type_end_object) {
+        // Anything still deferred follows a missing field
+        eosio::check(deferred.empty() || deferred.back().depth != depth,
+            eosio::convert_json_error(eosio::from_json_error::unexpected_field));
+        if (deferred.empty())
+            state.release_captured();
+        return false;
+    }
+    auto key = token.key;
+    auto next = stack_entry.position + 1;
+    if (next < (ptrdiff_t)fields.size() && key == fields[next].name)
+        return false;
+    auto it = std::find_if(fields.begin(), fields.end(), [&](auto& field) { return field.name == key; });
+    state.eat_token();
+    if (it == fields.end()) {
+        state.skip_value();
+        return true;
+    }
+    int field = it - fields.begin();
+    if (field <= stack_entry.position) {
+        state.reorder_failed = true;
+        return true;
     }
-    eosio::check(state.complete(),
-        eosio::convert_json_error(eosio::from_json_error::expected_end));
-
-    size_t pos = 0;
-    for (auto& insertion : state.size_insertions) {
-        bin.insert(bin.end(), out_buf.begin() + pos, out_buf.begin() + insertion.position);
-        eosio::push_varuint32(bin, insertion.size);
-        pos = insertion.position;
+    if (trace_json_to_bin)
+        printf("%*sdefer field %s\n", int(depth * 4), "", it->name.c_str());
+    auto tokens = state.capture_value();
+    for (auto d = deferred.end(); d != deferred.begin() && (d - 1)->depth == depth;) {
+        if ((--d)->field == field) {
+            d->tokens = tokens;
+            return true;
+        }
     }
-    bin.insert(bin.end(), out_buf.begin() + pos, out_buf.end());
+    deferred.push_back({depth, field, tokens});
+    return true;
 }
 
 inline void json_to_bin(pseudo_object*, json_to_bin_state& state, bool allow_extensions,
@@ -833,6 +1184,8 @@ inline void json_to_bin(pseudo_object*, json_to_bin_state& state, bool allow_ext
     }
     auto& stack_entry = state.stack.back();
     const std::vector<eosio::abi_field>& fields = type->as_struct()->fields;
+    if (state.reorder && json_to_bin_reorder_step(state, stack_entry, fields))
+        return;
     if (state.get_end_object_pred()) {
         if (stack_entry.position + 1 != (ptrdiff_t)fields.size()) {
             auto& field = fields[stack_entry.position + 1];
@@ -884,7 +1237,7 @@ inline void json_to_bin(pseudo_szarray*, json_to_bin_state& state, bool, const a
             printf("%*s]\n", int((state.stack.size() - 1) * 4), "");
         eosio::check(static_cast<unsigned>(stack_entry.position) + 1 == type->as_szarray()->size, 
             eosio::convert_json_error(eosio::from_json_error::array_incorrect_length));
-        state.size_insertions.pop_back();
+        state.size_insertions.erase(state.size_insertions.begin() + stack_entry.size_insertion_index);
         state.stack.pop_back();
         return;
     }
@@ -965,11 +1318,10 @@ inline void json_to_bin(pseudo_variant*, json_to_bin_state& state, bool allow_ex
 ///////////////////////////////////////////////////////////////////////////////
 
 template<typename F>
-inline void bin_to_json(eosio::input_stream& bin, const abi_type* type, std::string& dest, F&& f) {
-    // FIXME: Write directly to the string instead of creating an additional buffer
-    std::vector<char> buffer;
-    eosio::vector_stream writer{buffer};
+inline void bin_to_json(eosio::input_stream& bin, const abi_type* type, eosio::segmented_stream& writer, F&& f,
+                        eosio::name_json_cache* name_cache) {
     bin_to_json_state state{bin, writer};
+    state.name_cache = name_cache;
     type->get_serializer()->bin_to_json(state, true, type, true);
     while (!state.stack.empty()) {
         f();
@@ -978,7 +1330,26 @@ inline void bin_to_json(eosio::input_stream& bin, const abi_type* type, std::str
         eosio::check(state.stack.size() <= max_stack_size,
             eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
     }
-    dest = std::string_view(writer.data.data(), writer.data.size());
+}
+
+template<typename F>
+inline void bin_to_json(eosio::input_stream& bin, const abi_type* type, std::string& dest, F&& f,
+                        eosio::name_json_cache* name_cache = nullptr) {
+    eosio::segmented_stream writer;
+    bin_to_json(bin, type, writer, f, name_cache);
+    dest.resize(writer.size());
+    writer.copy_to(dest.data());
+}
+
+// Hands the json to sink.write_segments() each time the page fills, even in the middle of one value
+// such as a large bytes field, so no more than a page of it sits in memory
+template<typename Sink, typename F>
+inline void bin_to_json(eosio::input_stream& bin, const abi_type* type, Sink& sink, F&& f,
+                        eosio::name_json_cache* name_cache = nullptr) {
+    eosio::segmented_stream writer;
+    writer.on_page_full = [&](const eosio::segmented_stream& full) { sink.write_segments(full); };
+    bin_to_json(bin, type, writer, f, name_cache);
+    sink.write_segments(writer);
 }
 
 inline void bin_to_json(bin_to_json_state& state, bool allow_extensions, const abi_type* type, bool start) {
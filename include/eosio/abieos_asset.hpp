@@ -344,7 +344,13 @@ inline void from_string(asset& result, S& stream) {
 
 template <typename S>
 void to_json(const asset& obj, S& stream) {
-   to_json(asset_to_string(obj.amount, obj.symbol.value), stream);
+   if (!is_plain_symbol_code(obj.symbol.value >> 8))
+      return to_json(asset_to_string(obj.amount, obj.symbol.value), stream);
+   char buf[max_asset_chars + 3];
+   buf[0]        = '"';
+   size_t size   = asset_to_chars(obj.amount, obj.symbol.value, buf + 1);
+   buf[size + 1] = '"';
+   stream.write(buf, size + 2);
 }
 
 template <typename S>
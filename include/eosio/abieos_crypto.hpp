@@ -114,11 +114,25 @@ public_key  public_key_from_string(std::string_view s);
 std::string private_key_to_string(const private_key& obj);
 private_key private_key_from_string(std::string_view s);
 std::string signature_to_string(const signature& obj);
+
+/// Converts count keys to strings in out, computing their checksums together
+void public_keys_to_strings(const public_key* keys, size_t count, std::string* out);
+
+/// Converts count signatures to strings in out, computing their checksums together
+void signatures_to_strings(const signature* signatures, size_t count, std::string* out);
 signature   signature_from_string(std::string_view s);
 
+// Key strings are a prefix and base58, so they never need escaping
+template <typename S>
+void write_json_key_string(const std::string& s, S& stream) {
+   stream.write('"');
+   stream.write(s.data(), s.size());
+   stream.write('"');
+}
+
 template <typename S>
 void to_json(const public_key& obj, S& stream) {
-   to_json(public_key_to_string(obj), stream);
+   write_json_key_string(public_key_to_string(obj), stream);
 }
 template <typename S>
 void from_json(public_key& obj, S& stream) {
@@ -127,7 +141,7 @@ void from_json(public_key& obj, S& stream) {
 }
 template <typename S>
 void to_json(const private_key& obj, S& stream) {
-   to_json(private_key_to_string(obj), stream);
+   write_json_key_string(private_key_to_string(obj), stream);
 }
 template <typename S>
 void from_json(private_key& obj, S& stream) {
@@ -135,13 +149,48 @@ void from_json(private_key& obj, S& stream) {
 }
 template <typename S>
 void to_json(const signature& obj, S& stream) {
-   return to_json(signature_to_string(obj), stream);
+   write_json_key_string(signature_to_string(obj), stream);
 }
 template <typename S>
 void from_json(signature& obj, S& stream) {
    obj = signature_from_string(stream.get_string());
 }
 
+template <typename S>
+void write_json_key_strings(const std::vector<std::string>& strings, S& stream) {
+   stream.write('[');
+   bool first = true;
+   for (auto& s : strings) {
+      if (first) {
+         increase_indent(stream);
+      } else {
+         stream.write(',');
+      }
+      write_newline(stream);
+      first = false;
+      write_json_key_string(s, stream);
+   }
+   if (!first) {
+      decrease_indent(stream);
+      write_newline(stream);
+   }
+   stream.write(']');
+}
+
+template <typename S>
+void to_json(const std::vector<public_key>& obj, S& stream) {
+   std::vector<std::string> strings(obj.size());
+   public_keys_to_strings(obj.data(), obj.size(), strings.data());
+   write_json_key_strings(strings, stream);
+}
+
+template <typename S>
+void to_json(const std::vector<signature>& obj, S& stream) {
+   std::vector<std::string> strings(obj.size());
+   signatures_to_strings(obj.data(), obj.size(), strings.data());
+   write_json_key_strings(strings, stream);
+}
+
 std::string to_base58(const char* d, size_t s );
 std::vector<char> from_base58(const std::string_view& s);
 
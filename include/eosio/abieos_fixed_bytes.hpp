@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include "fixed_bin_size.hpp"
 #include "from_json.hpp"
 #include "operators.hpp"
 #include "reflection.hpp"
@@ -214,6 +215,9 @@ EOSIO_REFLECT(checksum160, value);
 EOSIO_REFLECT(checksum256, value);
 EOSIO_REFLECT(checksum512, value);
 
+template <std::size_t Size, typename Word>
+struct fixed_bin_size<fixed_bytes<Size, Word>> : std::integral_constant<size_t, Size> {};
+
 template <typename T, std::size_t Size, typename S>
 void from_bin(fixed_bytes<Size, T>& obj, S& stream) {
    std::array<std::uint8_t, Size> bytes;
@@ -159,9 +159,40 @@ void from_json(name& obj, S& stream) {
 
 template <typename S>
 void to_json(const name& obj, S& stream) {
-   to_json(eosio::name_to_string(obj.value), stream);
+   // Name characters never need escaping
+   char   buf[15] = { '"' };
+   size_t size    = name_to_chars(obj.value, buf + 1);
+   buf[size + 1]  = '"';
+   stream.write(buf, size + 2);
 }
 
+/// Direct-mapped cache of names already formatted as quoted JSON strings. Decoded actions, traces
+/// and deltas repeat a small set of names (eosio.token, transfer, active, ...) many times over.
+class name_json_cache {
+ public:
+   template <typename S>
+   void write(uint64_t value, S& stream) {
+      auto& e = entries[(value * 0x9e37'79b9'7f4a'7c15ull) >> (64 - bits)];
+      if (e.value != value) {
+         e.value           = value;
+         e.size            = name_to_chars(value, e.json + 1) + 2;
+         e.json[e.size - 1] = '"';
+      }
+      stream.write(e.json, e.size);
+   }
+
+ private:
+   static constexpr int bits = 8;
+
+   // The initial state is a valid entry for name 0
+   struct entry {
+      uint64_t value    = 0;
+      uint8_t  size     = 2;
+      char     json[15] = { '"', '"' };
+   };
+   entry entries[1 << bits];
+};
+
 inline namespace literals {
 #if defined(__clang__)
 # pragma clang diagnostic push
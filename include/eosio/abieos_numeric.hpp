@@ -7,6 +7,7 @@
 #include <stdint.h>
 #include <string>
 #include <string_view>
+#include <eosio/base58.hpp>
 #include <eosio/from_json.hpp>
 
 #include "abieos_ripemd160.hpp"
@@ -26,18 +27,8 @@ ABIEOS_NODISCARD inline bool set_error(std::string& state, std::string error) {
     return false;
 }
 
-inline constexpr char base58_chars[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
-
-inline constexpr auto create_base58_map() {
-    std::array<int8_t, 256> base58_map{{0}};
-    for (unsigned i = 0; i < base58_map.size(); ++i)
-        base58_map[i] = -1;
-    for (unsigned i = 0; i < sizeof(base58_chars); ++i)
-        base58_map[base58_chars[i]] = i;
-    return base58_map;
-}
-
-inline constexpr auto base58_map = create_base58_map();
+using eosio::base58_chars;
+using eosio::base58_map;
 
 template <auto size>
 bool is_negative(const std::array<uint8_t, size>& a) {
@@ -54,21 +45,60 @@ void negate(std::array<uint8_t, size>& a) {
     }
 }
 
+// Multiplies the little-endian limbs in place by m and adds a, returning the carry out
+template <auto n>
+inline uint64_t mul_add_limbs(std::array<uint64_t, n>& limbs, uint64_t m, uint64_t a) {
+    uint64_t carry = a;
+    for (auto& limb : limbs) {
+#ifndef ABIEOS_NO_INT128
+        unsigned __int128 x = (unsigned __int128)limb * m + carry;
+        limb = uint64_t(x);
+        carry = uint64_t(x >> 64);
+#else
+        uint64_t a_lo = uint32_t(limb), a_hi = limb >> 32, m_lo = uint32_t(m), m_hi = m >> 32;
+        uint64_t lo_lo = a_lo * m_lo, hi_lo = a_hi * m_lo, lo_hi = a_lo * m_hi, hi_hi = a_hi * m_hi;
+        uint64_t cross = (lo_lo >> 32) + uint32_t(hi_lo) + lo_hi;
+        uint64_t lo = (cross << 32) | uint32_t(lo_lo);
+        uint64_t hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+        lo += carry;
+        hi += lo < carry;
+        limb = lo;
+        carry = hi;
+#endif
+    }
+    return carry;
+}
+
 template <auto size>
 inline void decimal_to_binary(std::array<uint8_t, size>& result,
                                                               std::string_view s) {
     memset(result.begin(), 0, result.size());
-    for (auto& src_digit : s) {
-       eosio::check(!(src_digit < '0' || src_digit > '9'),
+    if constexpr (size == 16) {
+        // 19 digits at a time into two 64-bit limbs
+        if (s.empty())
+            return;
+        std::array<uint64_t, 2> limbs{};
+        auto status = eosio::parse_decimal_chunks(s.data(), s.data() + s.size(), eosio::detail::max_unsigned[4],
+                                                  [&](uint64_t pow10, uint64_t chunk) { mul_add_limbs(limbs, pow10, chunk); });
+        eosio::check(status != eosio::parse_decimal_status::out_of_range,
+              eosio::convert_json_error(eosio::from_json_error::number_out_of_range));
+        eosio::check(status == eosio::parse_decimal_status::ok,
             eosio::convert_json_error(eosio::from_json_error::expected_int));
-        uint8_t carry = src_digit - '0';
-        for (auto& result_byte : result) {
-            int x = result_byte * 10 + carry;
-            result_byte = x;
-            carry = x >> 8;
+        for (int i = 0; i < 16; ++i)
+            result[i] = uint8_t(limbs[i / 8] >> (8 * (i % 8)));
+    } else {
+        for (auto& src_digit : s) {
+           eosio::check(!(src_digit < '0' || src_digit > '9'),
+                eosio::convert_json_error(eosio::from_json_error::expected_int));
+            uint8_t carry = src_digit - '0';
+            for (auto& result_byte : result) {
+                int x = result_byte * 10 + carry;
+                result_byte = x;
+                carry = x >> 8;
+            }
+            eosio::check(!carry,
+                  eosio::convert_json_error(eosio::from_json_error::number_out_of_range));
         }
-        eosio::check(!carry,
-              eosio::convert_json_error(eosio::from_json_error::number_out_of_range));
     }
 }
 
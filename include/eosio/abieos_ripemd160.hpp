@@ -414,4 +414,136 @@ inline int ripemd160_digest(const ripemd160_state* self, unsigned char* out) {
     }
 }
 
+
+/*
+ * Multi-buffer hashing. Lanes messages are hashed together, each 32-bit lane of a vector holding
+ * the state of one message. The vectors use the compiler's generic vector extension, so they become
+ * SSE or AVX2 registers when those are enabled and plain scalar code otherwise. Lanes which run out
+ * of blocks before the others keep their state through a mask.
+ */
+
+/* Fills out with block number block of the padded message */
+inline void ripemd160_padded_block(const unsigned char* data, size_t size, size_t block, unsigned char* out) {
+    size_t begin = block * 64;
+    size_t n = size > begin ? (size - begin < 64 ? size - begin : 64) : 0;
+    if (n)
+        memcpy(out, data + begin, n);
+    memset(out + n, 0, 64 - n);
+    if (size >= begin && size - begin < 64)
+        out[size - begin] = 0x80;
+    if (block == (size + 8) / 64) {
+        uint64_t bits = uint64_t(size) << 3;
+        for (int i = 0; i < 8; ++i)
+            out[56 + i] = uint8_t(bits >> (8 * i));
+    }
+}
+
+template <int Lanes>
+struct ripemd160_lanes;
+
+template <>
+struct ripemd160_lanes<4> {
+    typedef uint32_t word __attribute__((vector_size(16)));
+};
+
+template <>
+struct ripemd160_lanes<8> {
+    typedef uint32_t word __attribute__((vector_size(32)));
+};
+
+template <int Lanes>
+struct ripemd160_multi {
+    typedef typename ripemd160_lanes<Lanes>::word word;
+
+    /* One line of one round: 16 steps with boolean function F */
+#define RIPEMD160_MULTI_LINE(F, R, S, K, A, B, C, D, E)                                \
+    for (int w = 0; w < 16; w++) {                                                     \
+        word T = ROL(S[round][w], A + F(B, C, D) + x[R[round][w]] + K[round]) + E;     \
+        A = E;                                                                         \
+        E = D;                                                                         \
+        D = ROL(10, C);                                                                \
+        C = B;                                                                         \
+        B = T;                                                                         \
+    }
+
+    static void compress(word* h, const word* x) {
+        word AL = h[0], BL = h[1], CL = h[2], DL = h[3], EL = h[4];
+        word AR = h[0], BR = h[1], CR = h[2], DR = h[3], ER = h[4];
+        int round = 0;
+        RIPEMD160_MULTI_LINE(F1, RL, SL, KL, AL, BL, CL, DL, EL)
+        RIPEMD160_MULTI_LINE(F5, RR, SR, KR, AR, BR, CR, DR, ER)
+        round++;
+        RIPEMD160_MULTI_LINE(F2, RL, SL, KL, AL, BL, CL, DL, EL)
+        RIPEMD160_MULTI_LINE(F4, RR, SR, KR, AR, BR, CR, DR, ER)
+        round++;
+        RIPEMD160_MULTI_LINE(F3, RL, SL, KL, AL, BL, CL, DL, EL)
+        RIPEMD160_MULTI_LINE(F3, RR, SR, KR, AR, BR, CR, DR, ER)
+        round++;
+        RIPEMD160_MULTI_LINE(F4, RL, SL, KL, AL, BL, CL, DL, EL)
+        RIPEMD160_MULTI_LINE(F2, RR, SR, KR, AR, BR, CR, DR, ER)
+        round++;
+        RIPEMD160_MULTI_LINE(F5, RL, SL, KL, AL, BL, CL, DL, EL)
+        RIPEMD160_MULTI_LINE(F1, RR, SR, KR, AR, BR, CR, DR, ER)
+        word T = h[1] + CL + DR;
+        h[1] = h[2] + DL + ER;
+        h[2] = h[3] + EL + AR;
+        h[3] = h[4] + AL + BR;
+        h[4] = h[0] + BL + CR;
+        h[0] = T;
+    }
+
+#undef RIPEMD160_MULTI_LINE
+
+    /* Hashes count <= Lanes messages */
+    static void hash(const unsigned char* const* data, const size_t* sizes, size_t count,
+                     unsigned char (*out)[ripemd160_digest_size]) {
+        word h[5];
+        for (int i = 0; i < 5; ++i)
+            for (int lane = 0; lane < Lanes; ++lane)
+                h[i][lane] = initial_h[i];
+        size_t blocks[Lanes] = {};
+        size_t max_blocks = 0;
+        for (size_t lane = 0; lane < count; ++lane) {
+            blocks[lane] = (sizes[lane] + 8) / 64 + 1;
+            max_blocks = blocks[lane] > max_blocks ? blocks[lane] : max_blocks;
+        }
+        for (size_t block = 0; block < max_blocks; ++block) {
+            word x[16] = {};
+            word active = {};
+            for (size_t lane = 0; lane < count; ++lane) {
+                if (block >= blocks[lane])
+                    continue;
+                unsigned char b[64];
+                ripemd160_padded_block(data[lane], sizes[lane], block, b);
+                for (int i = 0; i < 16; ++i)
+                    x[i][lane] = uint32_t(b[4 * i]) | uint32_t(b[4 * i + 1]) << 8 | uint32_t(b[4 * i + 2]) << 16 |
+                                 uint32_t(b[4 * i + 3]) << 24;
+                active[lane] = ~0u;
+            }
+            word next[5] = {h[0], h[1], h[2], h[3], h[4]};
+            compress(next, x);
+            for (int i = 0; i < 5; ++i)
+                h[i] = (next[i] & active) | (h[i] & ~active);
+        }
+        for (size_t lane = 0; lane < count; ++lane)
+            for (int i = 0; i < 20; ++i)
+                out[lane][i] = uint8_t(h[i / 4][lane] >> (8 * (i % 4)));
+    }
+};
+
+#ifdef __AVX2__
+inline constexpr int ripemd160_batch_lanes = 8;
+#else
+inline constexpr int ripemd160_batch_lanes = 4;
+#endif
+
+/* Hashes count messages, ripemd160_batch_lanes at a time */
+inline void ripemd160_batch(const unsigned char* const* data, const size_t* sizes, size_t count,
+                            unsigned char (*out)[ripemd160_digest_size]) {
+    for (size_t i = 0; i < count; i += ripemd160_batch_lanes) {
+        size_t n = count - i < ripemd160_batch_lanes ? count - i : ripemd160_batch_lanes;
+        ripemd160_multi<ripemd160_batch_lanes>::hash(data + i, sizes + i, n, out + i);
+    }
+}
+
 } // namespace ripemd160
@@ -169,7 +169,12 @@ EOSIO_COMPARE(symbol_code);
 
 template <typename S>
 void to_json(const symbol_code& obj, S& stream) {
-   to_json(symbol_code_to_string(obj.value), stream);
+   if (!is_plain_symbol_code(obj.value))
+      return to_json(symbol_code_to_string(obj.value), stream);
+   char   buf[10] = { '"' };
+   size_t size    = symbol_code_to_chars(obj.value, buf + 1);
+   buf[size + 1]  = '"';
+   stream.write(buf, size + 2);
 }
 
 template <typename S>
@@ -247,7 +252,13 @@ EOSIO_COMPARE(symbol);
 
 template <typename S>
 void to_json(const symbol& obj, S& stream) {
-   to_json(symbol_to_string(obj.value), stream);
+   if (!is_plain_symbol_code(obj.value >> 8))
+      return to_json(symbol_to_string(obj.value), stream);
+   char buf[max_symbol_chars + 3];
+   buf[0]        = '"';
+   size_t size   = symbol_to_chars(obj.value, buf + 1);
+   buf[size + 1] = '"';
+   stream.write(buf, size + 2);
 }
 
 template <typename S>
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "abieos_ripemd160.hpp"
+#include <array>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace eosio {
+
+inline constexpr char base58_chars[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+inline constexpr auto create_base58_map() {
+   std::array<int8_t, 256> base58_map{ { 0 } };
+   for (unsigned i = 0; i < base58_map.size(); ++i) base58_map[i] = -1;
+   for (unsigned i = 0; i + 1 < sizeof(base58_chars); ++i) base58_map[base58_chars[i]] = i;
+   return base58_map;
+}
+
+inline constexpr auto base58_map = create_base58_map();
+
+namespace detail {
+
+   // The conversions work on 32-bit limbs, 5 base58 digits or 4 bytes at a time. 58^5 < 2^30, so
+   // limb * multiplier + carry always fits in 64 bits.
+   inline constexpr uint32_t base58_limb_radix = 58 * 58 * 58 * 58 * 58;
+
+   inline constexpr uint32_t pow58[] = { 1, 58, 58 * 58, 58 * 58 * 58, 58 * 58 * 58 * 58, base58_limb_radix };
+
+   // Stack storage for the limbs when the input is small, as keys and signatures are
+   struct base58_limbs {
+      uint32_t              small[128];
+      std::vector<uint32_t> large;
+
+      uint32_t* get(size_t count) {
+         if (count <= std::size(small))
+            return small;
+         large.resize(count);
+         return large.data();
+      }
+   };
+
+   // Encodes [data, data + size) followed by [tail, tail + tail_size) as if they were one buffer
+   inline void binary_to_base58(std::string& result, const uint8_t* data, size_t size, const uint8_t* tail,
+                                size_t tail_size) {
+      size_t total = size + tail_size;
+      auto   byte  = [&](size_t i) { return i < size ? data[i] : tail[i - size]; };
+      size_t zeros = 0;
+      while (zeros < total && !byte(zeros)) ++zeros;
+
+      // Little-endian limbs in radix 58^5, filled 32 bits of input at a time
+      base58_limbs storage;
+      uint32_t*    limbs = storage.get(total / 3 + 2);
+      size_t       n     = 0;
+      size_t       pos   = zeros;
+      while (pos < total) {
+         size_t   chunk = (total - pos) % 4 ? (total - pos) % 4 : 4;
+         uint64_t carry = 0;
+         for (size_t i = 0; i < chunk; ++i) carry = (carry << 8) | byte(pos + i);
+         pos += chunk;
+         for (size_t i = 0; i < n; ++i) {
+            uint64_t x = (uint64_t(limbs[i]) << (8 * chunk)) + carry;
+            limbs[i]   = uint32_t(x % base58_limb_radix);
+            carry      = x / base58_limb_radix;
+         }
+         for (; carry; carry /= base58_limb_radix) limbs[n++] = uint32_t(carry % base58_limb_radix);
+      }
+
+      size_t digits = n ? 5 * (n - 1) : 0;
+      if (n)
+         for (uint32_t top = limbs[n - 1]; top; top /= 58) ++digits;
+      size_t begin = result.size();
+      result.resize(begin + zeros + digits);
+      char* out = result.data() + begin;
+      for (size_t i = 0; i < zeros; ++i) *out++ = '1';
+      char* p = out + digits;
+      for (size_t i = 0; i < n; ++i) {
+         uint32_t limb = limbs[i];
+         for (int j = 0; j < 5 && p != out; ++j) {
+            *--p = base58_chars[limb % 58];
+            limb /= 58;
+         }
+      }
+   }
+
+   // The checksum keys and signatures carry: the first 4 bytes of ripemd160(data + suffix)
+   inline void base58_checksum(unsigned char (&digest)[abieos_ripemd160::ripemd160_digest_size], const char* data,
+                               size_t size, std::string_view suffix) {
+      abieos_ripemd160::ripemd160_state state;
+      abieos_ripemd160::ripemd160_init(&state);
+      if (size)
+         abieos_ripemd160::ripemd160_update(&state, data, int(size));
+      if (!suffix.empty())
+         abieos_ripemd160::ripemd160_update(&state, suffix.data(), int(suffix.size()));
+      abieos_ripemd160::ripemd160_digest(&state, digest);
+   }
+
+} // namespace detail
+
+/// Appends the base58 encoding of [data, data + size) to `result`
+inline void binary_to_base58(std::string& result, const char* data, size_t size) {
+   detail::binary_to_base58(result, reinterpret_cast<const uint8_t*>(data), size, nullptr, 0);
+}
+
+/// Appends the base58 encoding of [data, data + size) followed by its 4-byte checksum, the first
+/// bytes of ripemd160(data + suffix), to `result`. The checksum feeds the conversion straight after
+/// the data, so the two are never copied into one buffer.
+inline void binary_to_base58_check(std::string& result, const char* data, size_t size, std::string_view suffix) {
+   unsigned char digest[abieos_ripemd160::ripemd160_digest_size];
+   detail::base58_checksum(digest, data, size, suffix);
+   detail::binary_to_base58(result, reinterpret_cast<const uint8_t*>(data), size, digest, 4);
+}
+
+inline std::string binary_to_base58(std::string_view bin) {
+   std::string result;
+   binary_to_base58(result, bin.data(), bin.size());
+   return result;
+}
+
+/// Appends the bytes encoded by `s` to `result`. Returns false if `s` has a character which isn't
+/// base58, in which case `result` is left unchanged.
+template <typename Container>
+[[nodiscard]] bool base58_to_binary(Container& result, std::string_view s) {
+   int8_t valid = 0;
+   for (auto c : s) valid |= base58_map[uint8_t(c)];
+   if (valid < 0)
+      return false;
+   size_t zeros = 0;
+   while (zeros < s.size() && s[zeros] == '1') ++zeros;
+
+   // Little-endian limbs in radix 2^32, filled 5 digits of input at a time
+   detail::base58_limbs storage;
+   uint32_t*            limbs = storage.get(s.size() / 5 + 2);
+   size_t               n     = 0;
+   size_t               pos   = zeros;
+   while (pos < s.size()) {
+      size_t   chunk = (s.size() - pos) % 5 ? (s.size() - pos) % 5 : 5;
+      uint64_t carry = 0;
+      for (size_t i = 0; i < chunk; ++i) carry = carry * 58 + base58_map[uint8_t(s[pos + i])];
+      pos += chunk;
+      for (size_t i = 0; i < n; ++i) {
+         uint64_t x = uint64_t(limbs[i]) * detail::pow58[chunk] + carry;
+         limbs[i]   = uint32_t(x);
+         carry      = x >> 32;
+      }
+      if (carry)
+         limbs[n++] = uint32_t(carry);
+   }
+
+   size_t bytes = 4 * n;
+   while (bytes && !(limbs[(bytes - 1) / 4] >> (8 * ((bytes - 1) % 4)) & 0xff)) --bytes;
+   size_t begin = result.size();
+   result.resize(begin + zeros + bytes);
+   auto out = result.begin() + begin;
+   for (size_t i = 0; i < zeros; ++i) *out++ = 0;
+   for (size_t i = bytes; i-- > 0;) *out++ = uint8_t(limbs[i / 4] >> (8 * (i % 4)));
+   return true;
+}
+
+/// Appends the bytes encoded by `s`, less their 4-byte checksum, to `result` once the checksum
+/// matches ripemd160(bytes + suffix). The bytes are checked where they were decoded. Returns false,
+/// leaving `result` unchanged, if `s` has a character which isn't base58, holds no more than a
+/// checksum, or the checksum doesn't match.
+template <typename Container>
+[[nodiscard]] bool base58_check_to_binary(Container& result, std::string_view s, std::string_view suffix) {
+   size_t begin = result.size();
+   if (!base58_to_binary(result, s))
+      return false;
+   size_t size = result.size() - begin;
+   if (size <= 4) {
+      result.resize(begin);
+      return false;
+   }
+   unsigned char digest[abieos_ripemd160::ripemd160_digest_size];
+   auto          data = reinterpret_cast<const char*>(result.data()) + begin;
+   detail::base58_checksum(digest, data, size - 4, suffix);
+   if (memcmp(digest, data + size - 4, 4)) {
+      result.resize(begin);
+      return false;
+   }
+   result.resize(begin + size - 4);
+   return true;
+}
+
+} // namespace eosio
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "parse_decimal.hpp"
 #include "stream.hpp"
+#include <array>
 #include <chrono>
+#include <cstring>
+#include <limits>
 #include <stdint.h>
 #include <string>
 #include <string_view>
@@ -213,92 +217,142 @@ constexpr inline uint64_t string_to_name_strict(std::string_view str) {
    __builtin_unreachable();
 }
 
+inline constexpr char name_charmap[] = ".12345abcdefghijklmnopqrstuvwxyz";
+
+/// Writes the characters of `name` to `out`, which must have room for 13, and returns how many
+/// are significant (trailing dots are dropped). All 13 bytes are written so the loop has no branches.
+inline size_t name_to_chars(uint64_t name, char* out) {
+   out[12] = name_charmap[name & 0x0f];
+   for (int i = 0; i < 12; ++i) out[i] = name_charmap[(name >> (59 - 5 * i)) & 0x1f];
+   if (name & 0x0f)
+      return 13;
+   uint64_t chars = name >> 4;
+   return chars ? 12 - __builtin_ctzll(chars) / 5 : 0;
+}
+
 inline std::string name_to_string(uint64_t name) {
-   static const char* charmap = ".12345abcdefghijklmnopqrstuvwxyz";
-   std::string        str(13, '.');
-
-   uint64_t tmp = name;
-   for (uint32_t i = 0; i <= 12; ++i) {
-      char c      = charmap[tmp & (i == 0 ? 0x0f : 0x1f)];
-      str[12 - i] = c;
-      tmp >>= (i == 0 ? 4 : 5);
+   char buf[13];
+   return std::string(buf, name_to_chars(name, buf));
+}
+
+/// Converts `count` names. `buf` must have room for 13 * count characters; `out[i]` points into it.
+inline void names_to_strings(const uint64_t* names, size_t count, char* buf, std::string_view* out) {
+   for (size_t i = 0; i < count; ++i, buf += 13) out[i] = { buf, name_to_chars(names[i], buf) };
+}
+
+namespace detail {
+   // Name digit + 1 for each valid name character, 0 for everything else
+   inline constexpr auto name_char_table = [] {
+      std::array<uint8_t, 256> table{};
+      for (int i = 0; i < 32; ++i) table[uint8_t(name_charmap[i])] = i + 1;
+      return table;
+   }();
+} // namespace detail
+
+/// Strict conversion of `count` strings, with the same rules as try_string_to_name_strict. Stops at the
+/// first string which is not a valid name and returns its index; returns `count` if all are valid.
+inline size_t strings_to_names(const std::string_view* strs, size_t count, uint64_t* out) {
+   for (size_t i = 0; i < count; ++i) {
+      auto     s     = strs[i];
+      size_t   n     = s.size() < 12 ? s.size() : 12;
+      uint64_t name  = 0;
+      uint8_t  valid = 1;
+      for (size_t j = 0; j < n; ++j) {
+         uint8_t v = detail::name_char_table[uint8_t(s[j])];
+         valid &= v != 0;
+         name |= uint64_t((v - 1) & 0x1f) << (59 - 5 * j);
+      }
+      if (s.size() > 12) {
+         uint8_t v = detail::name_char_table[uint8_t(s[12])];
+         valid &= s.size() == 13 && v != 0 && v <= 16;
+         name |= (v - 1) & 0x0f;
+      }
+      if (!valid)
+         return i;
+      out[i] = name;
    }
+   return count;
+}
 
-   const auto last = str.find_last_not_of('.');
-   return str.substr(0, last + 1);
+/// The formatted date ("YYYY-MM-DDT") of the last day microseconds_to_chars was called with.
+/// Timestamps in a block or trace are nearly always on the same day, so the civil date
+/// conversion is rarely needed.
+struct timestamp_date_cache {
+   int64_t day = std::numeric_limits<int64_t>::min();
+   char    prefix[11];
+};
+
+inline timestamp_date_cache& thread_timestamp_date_cache() {
+   static thread_local timestamp_date_cache cache;
+   return cache;
 }
 
-inline std::string microseconds_to_str(uint64_t microseconds) {
-   std::string result;
-
-   auto append_uint = [&result](uint32_t value, int digits) {
-      char  s[20];
-      char* ch = s;
-      while (digits--) {
-         *ch++ = '0' + (value % 10);
-         value /= 10;
-      };
-      std::reverse(s, ch);
-      result.insert(result.end(), s, ch);
-   };
+/// Length of microseconds_to_chars output
+inline constexpr size_t timestamp_chars = 23;
+
+/// Writes `microseconds` since the epoch as "YYYY-MM-DDTHH:MM:SS.mmm" to `out`, which must have room
+/// for timestamp_chars. Only the last 4 digits of the year are written.
+inline void microseconds_to_chars(uint64_t microseconds, char* out, timestamp_date_cache& cache) {
+   constexpr int64_t us_per_day = 86'400'000'000;
+   int64_t           us         = microseconds;
+   int64_t           day        = us >= 0 ? us / us_per_day : -(-(us + 1) / us_per_day) - 1;
+   if (day != cache.day) {
+      year_month_day ymd{ sys_days{ days{ int(day) } } };
+      char*          p = cache.prefix;
+      uint32_t       y = ymd.year() % 10000;
+      cache.day        = day;
+      detail::write_2_digits(p, y / 100);
+      detail::write_2_digits(p + 2, y % 100);
+      p[4] = '-';
+      detail::write_2_digits(p + 5, ymd.month());
+      p[7] = '-';
+      detail::write_2_digits(p + 8, ymd.day());
+      p[10] = 'T';
+   }
+   // Unsigned so the product can't overflow at the extremes of the range
+   uint32_t ms = (uint64_t(us) - uint64_t(day) * us_per_day) / 1000;
+   memcpy(out, cache.prefix, 11);
+   detail::write_2_digits(out + 11, ms / 3600000);
+   out[13] = ':';
+   detail::write_2_digits(out + 14, ms / 60000 % 60);
+   out[16] = ':';
+   detail::write_2_digits(out + 17, ms / 1000 % 60);
+   out[19] = '.';
+   out[20] = '0' + ms % 1000 / 100;
+   detail::write_2_digits(out + 21, ms % 100);
+}
 
-   std::chrono::microseconds us{ microseconds };
-   sys_days                  sd(std::chrono::floor<days>(us));
-   auto                      ymd = year_month_day{ sd };
-   uint32_t                  ms  = (std::chrono::floor<std::chrono::milliseconds>(us) - sd.time_since_epoch()).count();
-   us -= sd.time_since_epoch();
-   append_uint((int)ymd.year(), 4);
-   result.push_back('-');
-   append_uint((unsigned)ymd.month(), 2);
-   result.push_back('-');
-   append_uint((unsigned)ymd.day(), 2);
-   result.push_back('T');
-   append_uint(ms / 3600000 % 60, 2);
-   result.push_back(':');
-   append_uint(ms / 60000 % 60, 2);
-   result.push_back(':');
-   append_uint(ms / 1000 % 60, 2);
-   result.push_back('.');
-   append_uint(ms % 1000, 3);
-   return result;
+inline std::string microseconds_to_str(uint64_t microseconds) {
+   char buf[timestamp_chars];
+   microseconds_to_chars(microseconds, buf, thread_timestamp_date_cache());
+   return std::string(buf, timestamp_chars);
 }
 
 [[nodiscard]] inline bool string_to_utc_seconds(uint32_t& result, const char*& s, const char* end, bool eat_fractional,
                                                 bool require_end) {
-   auto parse_uint = [&](uint32_t& result, int digits) {
-      result = 0;
-      while (digits--) {
-         if (s != end && *s >= '0' && *s <= '9')
-            result = result * 10 + *s++ - '0';
-         else
-            return false;
-      }
-      return true;
-   };
-   uint32_t y, m, d, h, min, sec;
-   if (!parse_uint(y, 4))
-      return false;
-   if (s == end || *s++ != '-')
-      return false;
-   if (!parse_uint(m, 2))
-      return false;
-   if (s == end || *s++ != '-')
-      return false;
-   if (!parse_uint(d, 2))
-      return false;
-   if (s == end || *s++ != 'T')
-      return false;
-   if (!parse_uint(h, 2))
+   // "YYYY-MM-DDTHH:MM:SS", checked as three overlapping 8 byte words. Xor with the layout turns
+   // separators into 0 and digits into their values, so every byte must then be at most 9 and
+   // separator bytes must be 0.
+   if (end - s < 19)
       return false;
-   if (s == end || *s++ != ':')
-      return false;
-   if (!parse_uint(min, 2))
-      return false;
-   if (s == end || *s++ != ':')
-      return false;
-   if (!parse_uint(sec, 2))
+   uint64_t a        = detail::load_8_chars(s) ^ detail::load_8_chars("0000-00-");
+   uint64_t b        = detail::load_8_chars(s + 3) ^ detail::load_8_chars("0-00-00T");
+   uint64_t c        = detail::load_8_chars(s + 11) ^ detail::load_8_chars("00:00:00");
+   auto     is_lt_10 = [](uint64_t v) {
+      return ((v & 0xf0f0'f0f0'f0f0'f0f0ull) | ((v + 0x0606'0606'0606'0606ull) & 0xf0f0'f0f0'f0f0'f0f0ull)) == 0;
+   };
+   if (!is_lt_10(a) || !is_lt_10(b) || !is_lt_10(c) || (a & 0xff00'00ff'0000'0000ull) ||
+       (b & 0xff00'00ff'0000'ff00ull) || (c & 0x0000'ff00'00ff'0000ull))
       return false;
-   result = sys_days(year_month_day{year_t{y}, month_t{m}, day_t{d}}.to_days()).time_since_epoch().count() * 86400 + h * 3600 + min * 60 + sec;
+   auto     byte = [](uint64_t v, int i) { return uint32_t(v >> (8 * i)) & 0xff; };
+   uint32_t y    = byte(a, 0) * 1000 + byte(a, 1) * 100 + byte(a, 2) * 10 + byte(a, 3);
+   uint32_t m    = byte(a, 5) * 10 + byte(a, 6);
+   uint32_t d    = byte(b, 5) * 10 + byte(b, 6);
+   uint32_t secs = (byte(c, 0) * 10 + byte(c, 1)) * 3600 + (byte(c, 3) * 10 + byte(c, 4)) * 60 + byte(c, 6) * 10 +
+                   byte(c, 7);
+   int64_t  day  = year_month_day{ year_t{ y }, month_t{ m }, day_t{ d } }.to_days().count();
+   result        = uint32_t(day * 86400 + secs);
+   s += 19;
    if (eat_fractional && s != end && *s == '.') {
       ++s;
       while (s != end && *s >= '0' && *s <= '9') ++s;
@@ -349,13 +403,16 @@ inline std::string microseconds_to_str(uint64_t microseconds) {
    return string_to_symbol_code(result, pos, end, true);
 }
 
+/// Writes the characters of a symbol code to `out`, which must have room for 8, and returns how many
+/// are significant (up to the highest non-zero byte)
+inline size_t symbol_code_to_chars(uint64_t v, char* out) {
+   for (int i = 0; i < 8; ++i) out[i] = char(v >> (8 * i));
+   return v ? 8 - __builtin_clzll(v) / 8 : 0;
+}
+
 inline std::string symbol_code_to_string(uint64_t v) {
-   std::string result;
-   while (v > 0) {
-      result += char(v & 0xFF);
-      v >>= 8;
-   }
-   return result;
+   char buf[8];
+   return std::string(buf, symbol_code_to_chars(v, buf));
 }
 
 [[nodiscard]] inline bool string_to_symbol(uint64_t& result, uint8_t precision, const char*& pos, const char* end,
@@ -383,13 +440,29 @@ inline std::string symbol_code_to_string(uint64_t v) {
    return string_to_symbol(result, pos, end, true);
 }
 
+/// Longest output of symbol_to_chars: "255," and a 7 character code
+inline constexpr size_t max_symbol_chars = 11;
+
+/// Writes `precision,CODE` to `out`, which must have room for max_symbol_chars + 1, and returns its length
+inline size_t symbol_to_chars(uint64_t v, char* out) {
+   char*   pos       = out;
+   uint8_t precision = v;
+   if (precision >= 100)
+      *pos++ = '0' + precision / 100;
+   if (precision >= 10)
+      *pos++ = '0' + precision / 10 % 10;
+   *pos++ = '0' + precision % 10;
+   *pos++ = ',';
+   return pos - out + symbol_code_to_chars(v >> 8, pos);
+}
+
 inline std::string symbol_to_string(uint64_t v) {
-   return std::to_string(v & 0xff) + "," + eosio::symbol_code_to_string(v >> 8);
+   char buf[max_symbol_chars + 1];
+   return std::string(buf, symbol_to_chars(v, buf));
 }
 
 [[nodiscard]] inline bool string_to_asset(int64_t& amount, uint64_t& symbol, const char*& s, const char* end,
                                           bool expect_end) {
-   // todo: check overflow
    while (s != end && *s == ' ') //
       ++s;
    uint64_t uamount   = 0;
@@ -399,14 +472,29 @@ inline std::string symbol_to_string(uint64_t v) {
       ++s;
       negative = true;
    }
-   while (s != end && *s >= '0' && *s <= '9') //
-      uamount = uamount * 10 + (*s++ - '0');
-   if (s != end && *s == '.') {
-      ++s;
-      while (s != end && *s >= '0' && *s <= '9') {
-         uamount = uamount * 10 + (*s++ - '0');
-         ++precision;
-      }
+   uint64_t max_amount = negative ? uint64_t(1) << 63 : ~uint64_t(0) >> 1;
+   // Fast path for the usual form: at most 19 digits and a '.' in a single pass, which can't wrap
+   const char* p     = s;
+   const char* limit = end - s > 19 ? s + 19 : end;
+   const char* dot   = nullptr;
+   for (; p != limit; ++p) {
+      unsigned d = uint8_t(*p - '0');
+      if (d < 10)
+         uamount = uamount * 10 + d;
+      else if (*p == '.' && !dot)
+         dot = p;
+      else
+         break;
+   }
+   if (p != limit || limit == end) {
+      if (uamount > max_amount)
+         return false;
+      precision = dot ? p - dot - 1 : 0;
+      s         = p;
+   } else {
+      uamount = 0;
+      if (!parse_decimal_amount(uamount, precision, s, end, max_amount))
+         return false;
    }
    if (negative)
       uamount = -uamount;
@@ -422,29 +510,52 @@ inline std::string symbol_to_string(uint64_t v) {
    return string_to_asset(amount, symbol, s, end, true);
 }
 
-inline std::string asset_to_string(int64_t amount, uint64_t symbol) {
-   std::string result;
-   uint64_t    uamount;
+/// Longest output of asset_to_chars: a sign, 255 fraction digits after "0.", a space and a 7 character code
+inline constexpr size_t max_asset_chars = 1 + 257 + 1 + 7;
+
+/// Writes `amount` formatted with the symbol's precision, then a space and the symbol code, to `out`,
+/// which must have room for max_asset_chars + 1. Returns the length. The width of the number is known
+/// from the precision and the digit count of the amount, so digits are written in place right to left.
+/// The symbol already holds its whole layout, the precision byte and the code's characters, so nothing
+/// is precomputed or cached per symbol.
+inline size_t asset_to_chars(int64_t amount, uint64_t symbol, char* out) {
+   uint64_t uamount   = amount < 0 ? -uint64_t(amount) : uint64_t(amount);
+   uint8_t  precision = symbol;
+   unsigned digits    = 1;
+   while (digits < 20 && uamount >= detail::pow10_u64[digits]) ++digits;
+   if (digits <= precision)
+      digits = precision + 1;
+   char* pos = out + (amount < 0);
+   char* end = pos + digits + (precision != 0);
+   char* p   = end;
    if (amount < 0)
-      uamount = -amount;
-   else
-      uamount = amount;
-   uint8_t precision = symbol;
-   if (precision) {
-      while (precision--) {
-         result += '0' + uamount % 10;
-         uamount /= 10;
-      }
-      result += '.';
+      out[0] = '-';
+   for (unsigned i = 0; i < precision; ++i) {
+      *--p = '0' + uamount % 10;
+      uamount /= 10;
    }
-   do {
-      result += '0' + uamount % 10;
+   if (precision)
+      *--p = '.';
+   while (p != pos) {
+      *--p = '0' + uamount % 10;
       uamount /= 10;
-   } while (uamount);
-   if (amount < 0)
-      result += '-';
-   std::reverse(result.begin(), result.end());
-   return result + ' ' + eosio::symbol_code_to_string(symbol >> 8);
+   }
+   *end++ = ' ';
+   return end - out + symbol_code_to_chars(symbol >> 8, end);
+}
+
+inline std::string asset_to_string(int64_t amount, uint64_t symbol) {
+   char buf[max_asset_chars + 1];
+   return std::string(buf, asset_to_chars(amount, symbol, buf));
+}
+
+/// True if a symbol code is made only of the characters string_to_symbol_code accepts, so it can be
+/// written to json without escaping
+inline bool is_plain_symbol_code(uint64_t v) {
+   for (; v; v >>= 8)
+      if (uint8_t(v - 'A') >= 26)
+         return false;
+   return true;
 }
 
 } // namespace eosio
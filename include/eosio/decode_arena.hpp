@@ -0,0 +1,140 @@
+#pragma once
+
+#include "from_bin.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace eosio {
+
+/// Monotonic memory for decoding. Allocations bump a pointer and are never freed one at a time;
+/// reset() releases everything at once. After the first reset the blocks are merged into one, so a
+/// steady stream of similar decodes stops calling malloc altogether.
+class decode_arena {
+ public:
+   static constexpr size_t default_block_size = 64 * 1024;
+
+   explicit decode_arena(size_t initial_size = default_block_size) { add_block(initial_size); }
+   decode_arena(const decode_arena&) = delete;
+   decode_arena& operator=(const decode_arena&) = delete;
+
+   void* allocate(size_t size, size_t align) {
+      auto p = (uintptr_t(pos) + align - 1) & ~uintptr_t(align - 1);
+      if (size > size_t(end - pos) || p + size > uintptr_t(end)) {
+         add_block(std::max(size + align, 2 * capacity()));
+         p = (uintptr_t(pos) + align - 1) & ~uintptr_t(align - 1);
+      }
+      pos = reinterpret_cast<char*>(p + size);
+      return reinterpret_cast<void*>(p);
+   }
+
+   /// Frees everything allocated from the arena. Objects still using it must not be touched again.
+   void reset() {
+      if (blocks.size() > 1) {
+         size_t total = capacity();
+         blocks.clear();
+         add_block(total);
+      } else {
+         pos = blocks.back().data.get();
+      }
+   }
+
+   size_t capacity() const {
+      size_t total = 0;
+      for (auto& b : blocks) total += b.size;
+      return total;
+   }
+
+ private:
+   struct block {
+      std::unique_ptr<char[]> data;
+      size_t                  size;
+   };
+
+   void add_block(size_t size) {
+      blocks.push_back({ std::unique_ptr<char[]>(new char[size]), size });
+      pos = blocks.back().data.get();
+      end = pos + size;
+   }
+
+   std::vector<block> blocks;
+   char*              pos;
+   char*              end;
+};
+
+namespace detail {
+   inline thread_local decode_arena* current_decode_arena = nullptr;
+}
+
+/// Makes `arena` the one arena_allocator picks up on this thread while the scope is alive
+class decode_arena_scope {
+ public:
+   explicit decode_arena_scope(decode_arena& arena) : prev{ detail::current_decode_arena } {
+      detail::current_decode_arena = &arena;
+   }
+   decode_arena_scope(const decode_arena_scope&) = delete;
+   decode_arena_scope& operator=(const decode_arena_scope&) = delete;
+   ~decode_arena_scope() { detail::current_decode_arena = prev; }
+
+ private:
+   decode_arena* prev;
+};
+
+/// Allocates from the decode_arena in scope when the container is created, or from the heap when
+/// there is none. Containers nested in variants and optionals are created while decoding, so they
+/// pick up the arena too, which std::pmr::polymorphic_allocator would not do without a process-wide
+/// default resource. Copies made outside a scope go to the heap.
+template <typename T>
+struct arena_allocator {
+   using value_type                             = T;
+   using propagate_on_container_move_assignment = std::false_type;
+   using is_always_equal                        = std::false_type;
+
+   decode_arena* arena = detail::current_decode_arena;
+
+   arena_allocator() noexcept = default;
+
+   template <typename U>
+   arena_allocator(const arena_allocator<U>& other) noexcept : arena{ other.arena } {}
+
+   T* allocate(size_t n) {
+      if (arena)
+         return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+      return std::allocator<T>{}.allocate(n);
+   }
+
+   void deallocate(T* p, size_t n) {
+      if (!arena)
+         std::allocator<T>{}.deallocate(p, n);
+   }
+
+   arena_allocator select_on_container_copy_construction() const { return {}; }
+
+   template <typename U>
+   bool operator==(const arena_allocator<U>& other) const {
+      return arena == other.arena;
+   }
+
+   template <typename U>
+   bool operator!=(const arena_allocator<U>& other) const {
+      return arena != other.arena;
+   }
+};
+
+template <typename T>
+using arena_vector = std::vector<T, arena_allocator<T>>;
+
+using arena_string = std::basic_string<char, std::char_traits<char>, arena_allocator<char>>;
+
+constexpr const char* get_type_name(arena_string*) { return "string"; }
+
+/// Decodes a T whose containers all live in `arena`
+template <typename T, typename S>
+T from_bin_in_arena(decode_arena& arena, S& stream) {
+   decode_arena_scope scope{ arena };
+   T                  result;
+   from_bin(result, stream);
+   return result;
+}
+
+} // namespace eosio
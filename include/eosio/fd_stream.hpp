@@ -0,0 +1,111 @@
+#pragma once
+
+#include "stream.hpp"
+#include <errno.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace eosio {
+
+/// Output stream which writes to a file descriptor through a fixed-size buffer, so output of any
+/// size is written with bounded memory. Writes larger than the buffer and segmented_stream contents
+/// go out with writev alongside whatever is buffered, without another copy. The destructor flushes
+/// but ignores errors; call flush() to see them.
+struct fd_stream {
+   int               fd;
+   std::vector<char> buffer;
+   char*             pos;
+   char*             end;
+   uint64_t          written = 0;
+
+   static constexpr size_t default_buffer_size = 64 * 1024;
+
+   explicit fd_stream(int fd, size_t buffer_size = default_buffer_size) : fd{ fd }, buffer(buffer_size) {
+      check(buffer_size > 0, "fd_stream buffer_size must be positive");
+      pos = buffer.data();
+      end = buffer.data() + buffer.size();
+   }
+   fd_stream(const fd_stream&) = delete;
+   fd_stream& operator=(const fd_stream&) = delete;
+   ~fd_stream() {
+      try {
+         flush();
+      } catch (...) {}
+   }
+
+   void write(char c) {
+      if (pos == end)
+         flush();
+      *pos++ = c;
+   }
+
+   void write(const void* src, std::size_t sz) {
+      if (sz <= size_t(end - pos)) {
+         memcpy(pos, src, sz);
+         pos += sz;
+      } else if (sz < buffer.size()) {
+         flush();
+         memcpy(pos, src, sz);
+         pos += sz;
+      } else {
+         iovec iov[2] = { { buffer.data(), size_t(pos - buffer.data()) }, { const_cast<void*>(src), sz } };
+         write_all(iov, 2);
+         pos = buffer.data();
+      }
+   }
+
+   template <int Size>
+   void write(const char (&src)[Size]) {
+      write(src, Size);
+   }
+
+   template <typename T>
+   void write_raw(const T& v) {
+      write(&v, sizeof(v));
+   }
+
+   /// Writes the buffered bytes followed by everything in `segments`
+   void write_segments(const segmented_stream& segments) {
+      if (segments.size() <= size_t(end - pos)) {
+         segments.copy_to(pos);
+         pos += segments.size();
+         return;
+      }
+      std::vector<iovec> iov{ { buffer.data(), size_t(pos - buffer.data()) } };
+      segments.for_each_segment(
+            [&](const char* data, size_t size) { iov.push_back({ const_cast<char*>(data), size }); });
+      write_all(iov.data(), iov.size());
+      pos = buffer.data();
+   }
+
+   void flush() {
+      iovec iov{ buffer.data(), size_t(pos - buffer.data()) };
+      write_all(&iov, 1);
+      pos = buffer.data();
+   }
+
+ private:
+   // Retries short writes and EINTR. Entries in iov are consumed.
+   void write_all(iovec* iov, size_t count) {
+      while (count && !iov->iov_len) ++iov, --count;
+      while (count) {
+         ssize_t n = ::writev(fd, iov, int(std::min(count, size_t(IOV_MAX))));
+         if (n < 0 && errno == EINTR)
+            continue;
+         check(n >= 0, convert_stream_error(stream_error::write_error));
+         written += n;
+         for (size_t left = n; left;) {
+            size_t step = std::min(left, iov->iov_len);
+            iov->iov_base = static_cast<char*>(iov->iov_base) + step;
+            iov->iov_len -= step;
+            left -= step;
+            if (!iov->iov_len)
+               ++iov, --count;
+         }
+         while (count && !iov->iov_len) ++iov, --count;
+      }
+   }
+};
+
+} // namespace eosio
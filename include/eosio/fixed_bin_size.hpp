@@ -0,0 +1,48 @@
+#pragma once
+
+#include "for_each_field.hpp"
+#include "stream.hpp"
+#include <array>
+#include <type_traits>
+
+namespace eosio {
+
+/// Number of bytes every value of T serializes to in the binary format, or 0 if it depends on the
+/// value. Bitwise-serializable types, std::array of fixed-size types and reflected structs whose
+/// members are all fixed-size qualify. Reflected types with their own from_bin/to_bin specialize this.
+template <typename T>
+struct fixed_bin_size;
+
+template <typename T>
+inline constexpr size_t fixed_bin_size_v = fixed_bin_size<T>::value;
+
+template <typename T>
+constexpr size_t reflected_fixed_bin_size() {
+   size_t size  = 0;
+   bool   fixed = true;
+   for_each_field<T>([&](const char*, auto member) {
+      size_t member_size = fixed_bin_size_v<std::decay_t<decltype(member(std::declval<T*>()))>>;
+      size += member_size;
+      fixed = fixed && member_size;
+   });
+   return fixed ? size : 0;
+}
+
+template <typename T>
+struct fixed_bin_size {
+   static constexpr size_t value = [] {
+      if constexpr (has_bitwise_serialization<T>())
+         return sizeof(T);
+      else if constexpr (reflection::has_for_each_field_v<T>)
+         return reflected_fixed_bin_size<T>();
+      else
+         return size_t(0);
+   }();
+};
+
+template <typename T, std::size_t N>
+struct fixed_bin_size<std::array<T, N>> {
+   static constexpr size_t value = N * fixed_bin_size_v<T>;
+};
+
+} // namespace eosio
@@ -2,8 +2,10 @@
 
 #include <deque>
 #include "convert.hpp"
+#include "fixed_bin_size.hpp"
 #include "for_each_field.hpp"
 #include "stream.hpp"
+#include "variant_dispatch.hpp"
 #include <list>
 #include <map>
 #include <optional>
@@ -19,8 +21,49 @@ namespace eosio {
 template <typename T, typename S>
 void from_bin(T& obj, S& stream);
 
+namespace detail {
+
+   // Decodes the varuint at p without bounds checks; the caller guarantees max_bytes are readable.
+   // Returns the number of bytes, or 0 if none of the first max_bytes ends the value. Each step is a
+   // well-predicted branch rather than a loop with a bounds check per byte.
+   template <int max_bytes>
+   inline unsigned decode_varuint_unchecked(const char* data, uint64_t& value) {
+      auto     p      = reinterpret_cast<const uint8_t*>(data);
+      uint64_t result = p[0];
+      if (result < 0x80) {
+         value = result;
+         return 1;
+      }
+      result &= 0x7f;
+      for (int i = 1; i < max_bytes; ++i) {
+         uint64_t b = p[i];
+         result |= (b & 0x7f) << (7 * i);
+         if (b < 0x80) {
+            value = result;
+            return i + 1;
+         }
+      }
+      return 0;
+   }
+
+} // namespace detail
+
 template <typename S>
 void varuint32_from_bin(uint32_t& dest, S& stream) {
+   if constexpr (std::is_same_v<S, input_stream>) {
+      if (stream.pos != stream.end && uint8_t(*stream.pos) < 0x80) {
+         dest = uint8_t(*stream.pos++);
+         return;
+      }
+      if (stream.remaining() >= 5) {
+         uint64_t value;
+         unsigned bytes = detail::decode_varuint_unchecked<5>(stream.pos, value);
+         check( bytes, convert_stream_error(stream_error::invalid_varuint_encoding) );
+         dest = uint32_t(value);
+         stream.pos += bytes;
+         return;
+      }
+   }
    dest          = 0;
    int     shift = 0;
    uint8_t b     = 0;
@@ -34,6 +77,18 @@ void varuint32_from_bin(uint32_t& dest, S& stream) {
 
 template <typename S>
 void varuint64_from_bin(uint64_t& dest, S& stream) {
+   if constexpr (std::is_same_v<S, input_stream>) {
+      if (stream.pos != stream.end && uint8_t(*stream.pos) < 0x80) {
+         dest = uint8_t(*stream.pos++);
+         return;
+      }
+      if (stream.remaining() >= 10) {
+         unsigned bytes = detail::decode_varuint_unchecked<10>(stream.pos, dest);
+         check( bytes, convert_stream_error(stream_error::invalid_varuint_encoding) );
+         stream.pos += bytes;
+         return;
+      }
+   }
    dest          = 0;
    int     shift = 0;
    uint8_t b     = 0;
@@ -108,8 +163,8 @@ void from_bin(T (&v)[N], S& stream) {
    }
 }
 
-template <typename T, typename S>
-void from_bin(std::vector<T>& v, S& stream) {
+template <typename T, typename A, typename S>
+void from_bin(std::vector<T, A>& v, S& stream) {
    if constexpr (has_bitwise_serialization<T>()) {
       if constexpr (sizeof(size_t) >= 8) {
          uint64_t size;
@@ -183,8 +238,8 @@ void from_bin(std::pair<First, Second>& obj, S& stream) {
    from_bin(obj.second, stream);
 }
 
-template <typename S>
-inline void from_bin(std::string& obj, S& stream) {
+template <typename A, typename S>
+inline void from_bin(std::basic_string<char, std::char_traits<char>, A>& obj, S& stream) {
    uint32_t size;
    varuint32_from_bin(size, stream);
    obj.resize(size);
@@ -211,31 +266,22 @@ void from_bin(std::optional<T>& obj, S& stream) {
    from_bin(*obj, stream);
 }
 
-template <uint32_t I, typename... Ts, typename S>
-void variant_from_bin(std::variant<Ts...>& v, uint32_t i, S& stream) {
-   if constexpr (I < std::variant_size_v<std::variant<Ts...>>) {
-      if (i == I) {
-         auto& x = v.template emplace<I>();
-         from_bin(x, stream);
-      } else {
-         variant_from_bin<I + 1>(v, i, stream);
-      }
-   } else {
-      check( false, convert_stream_error(stream_error::bad_variant_index) );
-   }
-}
-
 template <typename... Ts, typename S>
 void from_bin(std::variant<Ts...>& obj, S& stream) {
    uint32_t u;
    varuint32_from_bin(u, stream);
-   variant_from_bin<0>(obj, u, stream);
+   check( u < sizeof...(Ts), convert_stream_error(stream_error::bad_variant_index) );
+   dispatch_index<sizeof...(Ts)>(u, [&](auto i) { from_bin(obj.template emplace<decltype(i)::value>(), stream); });
 }
 
 template <typename T, std::size_t N, typename S>
 void from_bin(std::array<T, N>& obj, S& stream) {
-   for (T& elem : obj) {
-      from_bin(elem, stream);
+   if constexpr (has_bitwise_serialization<T>()) {
+      stream.read(reinterpret_cast<char*>(obj.data()), N * sizeof(T));
+   } else {
+      for (T& elem : obj) {
+         from_bin(elem, stream);
+      }
    }
 }
 
@@ -257,9 +303,19 @@ void from_bin(T& obj, S& stream) {
    if constexpr (has_bitwise_serialization<T>()) {
       stream.read(reinterpret_cast<char*>(&obj), sizeof(T));
    } else if constexpr (std::is_same_v<serialization_type<T>, void>) {
-      for_each_field(obj, [&](auto& member) {
-         from_bin(member, stream);
-      });
+      if constexpr (std::is_same_v<S, input_stream> && fixed_bin_size_v<T> != 0) {
+         // One bounds check for the whole struct
+         stream.check_available(fixed_bin_size_v<T>);
+         unchecked_input_stream unchecked{ stream.pos };
+         for_each_field(obj, [&](auto& member) {
+            from_bin(member, unchecked);
+         });
+         stream.pos = unchecked.pos;
+      } else {
+         for_each_field(obj, [&](auto& member) {
+            from_bin(member, stream);
+         });
+      }
    } else {
       // TODO: This can operate in place for standard serializers
       decltype(serialize_as(obj)) temp;
@@ -7,6 +7,9 @@
 #include <optional>
 #include <rapidjson/reader.h>
 #include <vector>
+#include "json_structural_index.hpp"
+#include "parse_decimal.hpp"
+#include "variant_dispatch.hpp"
 #include <variant>
 #include <errno.h>
 #include <map>
@@ -186,25 +189,148 @@ const unsigned destructive_parse_flag = rapidjson::kParseInsituFlag | nondestruc
 
 class json_token_stream : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, json_token_stream> {
  private:
+   enum class index_state : uint8_t {
+      start,
+      object_start,
+      object_key,
+      object_value,
+      object_next,
+      array_start,
+      array_value,
+      array_next,
+      finish,
+   };
+
    rapidjson::Reader             reader;
    rapidjson::InsituStringStream ss;
 
+   // Set when tokenizing from a structural index instead of the rapidjson reader
+   const json_structural_index* index           = nullptr;
+   index_state                  istate          = index_state::start;
+   size_t                       next_structural = 0;
+   char*                        index_text      = nullptr;
+   char*                        read_pos        = nullptr;
+   std::vector<char>            containers;
+   std::string                  scratch;
+
+   // Tokens kept by capture_value, and the ranges of them being replayed (innermost last)
+   struct replay_frame {
+      size_t     next;
+      size_t     end;
+      json_token resume; // token that was peeked when the replay started
+   };
+   std::vector<json_token>   captured;
+   std::vector<replay_frame> replays;
+
+   bool next_replayed_token() {
+      while (!replays.empty()) {
+         auto& frame = replays.back();
+         if (frame.next != frame.end) {
+            current_token = captured[frame.next++];
+            return true;
+         }
+         current_token = frame.resume;
+         replays.pop_back();
+         if (current_token.type != json_token_type::type_unread)
+            return true;
+      }
+      return false;
+   }
+
  public:
    json_token current_token;
 
    // This modifies json
    json_token_stream(char* json) : ss{ json } { reader.IterativeParseInit(); }
 
-   bool complete() { return reader.IterativeParseComplete(); }
+   // Tokenize from a prebuilt index of json, or with the rapidjson reader if index is null. This modifies json.
+   json_token_stream(char* json, const json_structural_index* index)
+       : ss{ json }, index{ index }, index_text{ json }, read_pos{ json } {
+      reader.IterativeParseInit();
+   }
+
+   // Start over on another document, keeping the buffers allocated for the previous one. This modifies json.
+   void reset(char* json, const json_structural_index* index) {
+      reader.IterativeParseInit();
+      ss              = rapidjson::InsituStringStream{ json };
+      this->index     = index;
+      istate          = index_state::start;
+      next_structural = 0;
+      index_text      = json;
+      read_pos        = json;
+      current_token   = {};
+      containers.clear();
+      captured.clear();
+      replays.clear();
+   }
+
+   using token_range = std::pair<size_t, size_t>;
+
+   // Reads the next value, including everything nested in it, and keeps its tokens so they can be
+   // replayed later. The tokens point into the json text, so this needs destructive parsing.
+   token_range capture_value() {
+      size_t begin = captured.size();
+      int    depth = 0;
+      do {
+         json_token t = peek_token();
+         eat_token();
+         if (t.type == json_token_type::type_start_object || t.type == json_token_type::type_start_array)
+            ++depth;
+         else if (t.type == json_token_type::type_end_object || t.type == json_token_type::type_end_array)
+            --depth;
+         captured.push_back(t);
+      } while (depth > 0);
+      return { begin, captured.size() };
+   }
+
+   // Reads the next value and discards it
+   void skip_value() { captured.resize(capture_value().first); }
+
+   // The tokens in range are read next, then reading continues where it left off
+   void replay(token_range range) {
+      replays.push_back({ range.first, range.second, current_token });
+      current_token.type = json_token_type::type_unread;
+   }
+
+   // Drops the captured tokens. Only call once no range that hasn't been replayed is needed.
+   void release_captured() {
+      for (auto& frame : replays)
+         if (frame.next != frame.end)
+            return;
+      captured.clear();
+      for (auto& frame : replays) frame.next = frame.end = 0;
+   }
+
+   // The unread text, and any token it produced that is still held, moved from old_base to new_base. Callers that
+   // feed the document in pieces use this to slide or grow their buffer. Only valid with the rapidjson reader.
+   void rebase(const char* old_base, char* new_base) {
+      auto move = [&](std::string_view s) -> std::string_view { return { new_base + (s.data() - old_base), s.size() }; };
+      ss.src_ = ss.dst_ = ss.head_ = new_base + (ss.src_ - old_base);
+      if (current_token.type == json_token_type::type_key)
+         current_token = { current_token.type, move(current_token.key) };
+      else if (current_token.type == json_token_type::type_string)
+         current_token = { current_token.type, {}, false, move(current_token.value_string) };
+      else
+         current_token = { current_token.type, {}, current_token.value_bool };
+   }
+
+   bool complete() { return index ? istate == index_state::finish : reader.IterativeParseComplete(); }
 
-   const char* get_read_position() const { return ss.src_; }
+   const char* get_read_position() const { return index ? read_pos : ss.src_; }
 
    template <unsigned parseFlags>
    std::reference_wrapper<const json_token> peek_token_impl() {
       if (current_token.type != json_token_type::type_unread)
          return current_token;
-      check( reader.IterativeParseNext<parseFlags>(ss, *this),
-            convert_error_to_string_view(reader.GetParseErrorCode()) );
+      if (!replays.empty() && next_replayed_token())
+         return current_token;
+      if (index) {
+         next_indexed_token<(parseFlags & rapidjson::kParseInsituFlag) != 0>();
+         return current_token;
+      }
+      // The error code must be read after parsing; argument evaluation order is unspecified
+      bool ok = reader.IterativeParseNext<parseFlags>(ss, *this);
+      check(ok, convert_error_to_string_view(reader.GetParseErrorCode()));
       return current_token;
    }
 
@@ -351,6 +477,272 @@ class json_token_stream : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
       current_token.type = json_token_type::type_end_array;
       return true;
    }
+
+ private:
+   // Indexed tokenizer. Mirrors the rapidjson iterative reader: one token per call, with the same
+   // error for each malformed input.
+   template <bool insitu>
+   void next_indexed_token() {
+      while (true) {
+         char* p = next_indexed_char();
+         switch (istate) {
+            case index_state::start:
+               check(*p, convert_json_error(from_json_error::document_empty));
+               return indexed_value<insitu>(p);
+            case index_state::object_start:
+               if (*p == '}')
+                  return indexed_end(p, json_token_type::type_end_object);
+               check(*p == '"', convert_json_error(from_json_error::object_miss_name));
+               return indexed_key<insitu>(p);
+            case index_state::object_key:
+               check(*p == ':', convert_json_error(from_json_error::object_miss_colon));
+               advance(p + 1);
+               istate = index_state::object_value;
+               continue;
+            case index_state::object_next:
+               if (*p == '}')
+                  return indexed_end(p, json_token_type::type_end_object);
+               check(*p == ',', convert_json_error(from_json_error::object_miss_comma_or_curly_bracket));
+               advance(p + 1);
+               p = next_indexed_char();
+               check(*p == '"', convert_json_error(from_json_error::object_miss_name));
+               return indexed_key<insitu>(p);
+            case index_state::array_start:
+               if (*p == ']')
+                  return indexed_end(p, json_token_type::type_end_array);
+               return indexed_value<insitu>(p);
+            case index_state::array_next:
+               if (*p == ']')
+                  return indexed_end(p, json_token_type::type_end_array);
+               check(*p == ',', convert_json_error(from_json_error::array_miss_comma_or_square_bracket));
+               advance(p + 1);
+               istate = index_state::array_value;
+               continue;
+            case index_state::object_value:
+            case index_state::array_value: return indexed_value<insitu>(p);
+            default: check(false, convert_json_error(from_json_error::unspecific_syntax_error));
+         }
+      }
+   }
+
+   static bool is_json_whitespace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+   // The next significant character. Normally that's the next indexed position, but anything
+   // stuck directly to the end of the previous token isn't indexed and must be rejected too.
+   // Points at the terminating NUL once the input is exhausted.
+   char* next_indexed_char() const {
+      bool at_end = next_structural == index->count();
+      if (*read_pos && !is_json_whitespace(*read_pos) &&
+          (at_end || read_pos != index_text + (*index)[next_structural]))
+         return read_pos;
+      return at_end ? index_text + index->size() : index_text + (*index)[next_structural];
+   }
+
+   // Move past a token, skipping any index entries it covered
+   void advance(char* pos) {
+      read_pos = pos;
+      while (next_structural < index->count() && index_text + (*index)[next_structural] < read_pos)
+         ++next_structural;
+   }
+
+   void indexed_value_done() {
+      if (containers.empty()) {
+         istate = index_state::finish;
+         check(next_structural == index->count() && (!*read_pos || is_json_whitespace(*read_pos)),
+               convert_json_error(from_json_error::document_root_not_singular));
+      } else {
+         istate = containers.back() == '{' ? index_state::object_next : index_state::array_next;
+      }
+   }
+
+   void indexed_end(char* p, json_token_type type) {
+      advance(p + 1);
+      containers.pop_back();
+      current_token.type = type;
+      indexed_value_done();
+   }
+
+   template <bool insitu>
+   void indexed_key(char* p) {
+      current_token.key  = read_indexed_string<insitu>(p);
+      current_token.type = json_token_type::type_key;
+      istate             = index_state::object_key;
+   }
+
+   template <bool insitu>
+   void indexed_value(char* p) {
+      switch (*p) {
+         case '{':
+         case '[':
+            containers.push_back(*p);
+            istate             = *p == '{' ? index_state::object_start : index_state::array_start;
+            current_token.type = *p == '{' ? json_token_type::type_start_object : json_token_type::type_start_array;
+            advance(p + 1);
+            return;
+         case '"':
+            current_token.value_string = read_indexed_string<insitu>(p);
+            current_token.type         = json_token_type::type_string;
+            break;
+         case 't':
+         case 'f': {
+            bool v = *p == 't';
+            check(!strncmp(p, v ? "true" : "false", v ? 4 : 5), convert_json_error(from_json_error::value_invalid));
+            advance(p + (v ? 4 : 5));
+            current_token.value_bool = v;
+            current_token.type       = json_token_type::type_bool;
+            break;
+         }
+         case 'n':
+            check(!strncmp(p, "null", 4), convert_json_error(from_json_error::value_invalid));
+            advance(p + 4);
+            current_token.type = json_token_type::type_null;
+            break;
+         default:
+            current_token.value_string = read_indexed_number(p);
+            current_token.type         = json_token_type::type_string;
+      }
+      indexed_value_done();
+   }
+
+   std::string_view read_indexed_number(char* p) {
+      auto  is_digit = [](char c) { return c >= '0' && c <= '9'; };
+      char* q        = p;
+      if (*q == '-')
+         ++q;
+      if (*q == '0') {
+         ++q;
+      } else {
+         check(*q >= '1' && *q <= '9', convert_json_error(from_json_error::value_invalid));
+         while (is_digit(*q)) ++q;
+      }
+      if (*q == '.') {
+         check(is_digit(*++q), convert_json_error(from_json_error::number_miss_fraction));
+         while (is_digit(*q)) ++q;
+      }
+      if (*q == 'e' || *q == 'E') {
+         ++q;
+         if (*q == '+' || *q == '-')
+            ++q;
+         check(is_digit(*q), convert_json_error(from_json_error::number_miss_exponent));
+         while (is_digit(*q)) ++q;
+      }
+      advance(q);
+      return { p, size_t(q - p) };
+   }
+
+   // p points at the opening quote. Strings are unescaped in place when insitu, otherwise into scratch.
+   template <bool insitu>
+   std::string_view read_indexed_string(char* p) {
+      char* const begin = p + 1;
+      char*       s     = begin;
+
+      // Blocks without escapes, control or non-ASCII bytes need no decoding or validation
+      char* const text_end = index_text + index->size();
+      while (s < text_end && index->is_simple_block(s - index_text)) {
+         size_t block_end = std::min((s - index_text) / json_structural_index::block_size * json_structural_index::block_size +
+                                           json_structural_index::block_size,
+                                     index->size());
+         if (auto q = static_cast<char*>(memchr(s, '"', index_text + block_end - s))) {
+            advance(q + 1);
+            if constexpr (insitu)
+               *q = 0;
+            return { begin, size_t(q - begin) };
+         }
+         s = index_text + block_end;
+      }
+
+      char* dst = s;
+      if constexpr (!insitu)
+         scratch.assign(begin, s);
+      auto put = [&](char ch) {
+         if constexpr (insitu)
+            *dst++ = ch;
+         else
+            scratch.push_back(ch);
+      };
+      auto hex4 = [&] {
+         unsigned cp = 0;
+         for (int i = 0; i < 4; ++i) {
+            char     h = *s++;
+            unsigned d = 0;
+            if (h >= '0' && h <= '9')
+               d = h - '0';
+            else if (h >= 'a' && h <= 'f')
+               d = h - 'a' + 10;
+            else if (h >= 'A' && h <= 'F')
+               d = h - 'A' + 10;
+            else
+               check(false, convert_json_error(from_json_error::string_unicode_escape_invalid_hex));
+            cp = (cp << 4) | d;
+         }
+         return cp;
+      };
+
+      while (*s != '"') {
+         auto c = uint8_t(*s);
+         if (c == '\\') {
+            ++s;
+            switch (*s++) {
+               case '"': put('"'); break;
+               case '\\': put('\\'); break;
+               case '/': put('/'); break;
+               case 'b': put('\b'); break;
+               case 'f': put('\f'); break;
+               case 'n': put('\n'); break;
+               case 'r': put('\r'); break;
+               case 't': put('\t'); break;
+               case 'u': {
+                  unsigned cp = hex4();
+                  if (cp >= 0xd800 && cp <= 0xdbff) {
+                     check(s[0] == '\\' && s[1] == 'u',
+                           convert_json_error(from_json_error::string_unicode_surrogate_invalid));
+                     s += 2;
+                     unsigned low = hex4();
+                     check(low >= 0xdc00 && low <= 0xdfff,
+                           convert_json_error(from_json_error::string_unicode_surrogate_invalid));
+                     cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                  } else {
+                     check(cp < 0xdc00 || cp > 0xdfff,
+                           convert_json_error(from_json_error::string_unicode_surrogate_invalid));
+                  }
+                  if (cp < 0x80) {
+                     put(cp);
+                  } else if (cp < 0x800) {
+                     put(0xc0 | (cp >> 6));
+                     put(0x80 | (cp & 0x3f));
+                  } else if (cp < 0x10000) {
+                     put(0xe0 | (cp >> 12));
+                     put(0x80 | ((cp >> 6) & 0x3f));
+                     put(0x80 | (cp & 0x3f));
+                  } else {
+                     put(0xf0 | (cp >> 18));
+                     put(0x80 | ((cp >> 12) & 0x3f));
+                     put(0x80 | ((cp >> 6) & 0x3f));
+                     put(0x80 | (cp & 0x3f));
+                  }
+                  break;
+               }
+               default: check(false, convert_json_error(from_json_error::string_escape_invalid));
+            }
+         } else if (c < 0x20) {
+            check(false, convert_json_error(c ? from_json_error::string_invalid_encoding
+                                              : from_json_error::string_miss_quotation_mark));
+         } else if (c < 0x80) {
+            put(*s++);
+         } else {
+            int n = utf8_sequence_length(s);
+            check(n, convert_json_error(from_json_error::string_invalid_encoding));
+            while (n--) put(*s++);
+         }
+      }
+      advance(s + 1);
+      if constexpr (insitu) {
+         *dst = 0;
+         return { begin, size_t(dst - begin) };
+      } else {
+         return scratch;
+      }
+   }
 }; // json_token_stream
 
 template <typename SrcIt, typename DestIt>
@@ -389,41 +781,17 @@ void from_json(std::string_view& result, S& stream) {
 
 /// \group from_json_explicit Parse JSON (Explicit Types)
 /// Parse JSON and convert to `result`. These overloads handle specified types.
-template <typename S>
-void from_json(std::string& result, S& stream) {
+template <typename A, typename S>
+void from_json(std::basic_string<char, std::char_traits<char>, A>& result, S& stream) {
    result = stream.get_string();
 }
 
 /// \exclude
 template <typename T, typename S>
 void from_json_int(T& result, S& stream) {
-   auto r = stream.get_string();
-   auto pos   = r.data();
-   auto end   = pos + r.size();
-   bool found = false;
-   result     = 0;
-   T limit;
-   T sign;
-   if (std::is_signed_v<T> && pos != end && *pos == '-') {
-      ++pos;
-      sign  = -1;
-      limit = std::numeric_limits<T>::min();
-   } else {
-      sign  = 1;
-      limit = std::numeric_limits<T>::max();
-   }
-   while (pos != end && *pos >= '0' && *pos <= '9') {
-      T digit = (*pos++ - '0');
-      // abs(result) can overflow.  Use -abs(result) instead.
-      // TODO refactor this logic, don't have time now
-      check(!(std::is_signed_v<T> && (-sign * limit + digit) / 10 > -sign * result),
-            convert_json_error(from_json_error::number_out_of_range) );
-      check(!(!std::is_signed_v<T> && (limit - digit) / 10 < result),
-            convert_json_error(from_json_error::number_out_of_range) );
-      result = result * 10 + sign * digit;
-      found  = true;
-   }
-   check( pos == end && found, convert_json_error(from_json_error::expected_int) );
+   auto status = parse_decimal(result, stream.get_string());
+   check(status != parse_decimal_status::out_of_range, convert_json_error(from_json_error::number_out_of_range));
+   check(status == parse_decimal_status::ok, convert_json_error(from_json_error::expected_int));
 }
 
 /// \group from_json_explicit
@@ -550,8 +918,8 @@ void from_json(bool& result, S& stream) {
 }
 
 /// \group from_json_explicit
-template <typename T, typename S>
-void from_json(std::vector<T>& result, S& stream) {
+template <typename T, typename A, typename S>
+void from_json(std::vector<T, A>& result, S& stream) {
    stream.get_start_array();
    while (true) {
       auto t = stream.peek_token();
@@ -585,26 +953,16 @@ void from_json(std::map<Key, Val>& result, S& stream) {
 }
 
 
-template <int N = 0, typename... T>
-void set_variant_impl(std::variant<T...>& result, uint32_t type) {
-   if (type == N) {
-      result.template emplace<N>();
-   } else if constexpr (N + 1 < sizeof...(T)) {
-      set_variant_impl<N + 1>(result, type);
-   }
-}
-
 /// \group from_json_explicit
 template <typename... T, typename S>
 void from_json(std::variant<T...>& result, S& stream) {
    stream.get_start_array();
    std::string_view type;
    from_json(type, stream);
-   const char* const type_names[] = { get_type_name((T*)nullptr)... };
-   uint32_t          type_idx     = std::find(type_names, type_names + sizeof...(T), type) - type_names;
+   static constexpr std::string_view type_names[] = { get_type_name((T*)nullptr)... };
+   uint32_t type_idx = std::find(std::begin(type_names), std::end(type_names), type) - std::begin(type_names);
    check( type_idx < sizeof...(T), convert_json_error(from_json_error::invalid_type_for_variant) );
-   set_variant_impl(result, type_idx);
-   std::visit([&](auto& x) { from_json(x, stream); }, result);
+   dispatch_index<sizeof...(T)>(type_idx, [&](auto i) { from_json(result.template emplace<decltype(i)::value>(), stream); });
    stream.get_end_array();
 }
 
@@ -0,0 +1,237 @@
+#pragma once
+
+#include "check.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace eosio {
+
+/// Positions of the structural characters (`{}[]:,`), string starts and scalar starts of a JSON
+/// document, computed 64 bytes at a time. The document is classified with SIMD compares where
+/// available; quote, escape and in-string state is resolved with carry-less bit arithmetic so the
+/// scan never branches on content. `json_token_stream` walks these positions instead of
+/// re-tokenizing the text byte by byte.
+///
+/// The index does not report errors itself. Anything it cannot classify (an unterminated string,
+/// bad escapes, invalid UTF-8, garbage between tokens) is left for the token stream to reject when
+/// it reaches that point, so errors surface in the same order and with the same messages as the
+/// rapidjson reader.
+class json_structural_index {
+ public:
+   static constexpr size_t block_size = 64;
+
+   json_structural_index() = default;
+   json_structural_index(const char* json, size_t size) { build(json, size); }
+
+   /// Documents at least this large can't be indexed; positions are stored as 32-bit offsets
+   static constexpr size_t max_size = UINT32_MAX;
+
+   /// Index `json`. Scanning stops at the first NUL byte, which rapidjson treats as end of input.
+   /// The text must remain alive (and NUL-terminated) while the index is in use.
+   void build(const char* json, size_t size) {
+      check(size < max_size, "json document is too large to index");
+      data = json;
+      len  = 0;
+      positions.clear();
+      complex_blocks.clear();
+      positions.reserve(size / 4 + 8);
+      complex_blocks.reserve(size / block_size + 1);
+
+      block_state state;
+      size_t      pos = 0;
+      bool        end = false;
+      for (; !end && pos < size; pos += block_size) {
+         masks m;
+         if (size - pos >= block_size) {
+            classify(json + pos, m);
+         } else {
+            char tail[block_size] = {};
+            memcpy(tail, json + pos, size - pos);
+            classify(tail, m);
+         }
+         uint64_t valid = ~uint64_t(0);
+         if (size - pos < block_size)
+            valid = (uint64_t(1) << (size - pos)) - 1;
+         if (uint64_t zero = m.zero & valid) {
+            valid &= (zero & -zero) - 1; // the bytes before the first NUL
+            end = true;
+         }
+         len = pos + (valid == ~uint64_t(0) ? block_size : __builtin_popcountll(valid));
+         complex_blocks.push_back(((m.backslash | m.control | m.high) & valid) != 0);
+         append_structurals(uint32_t(pos), state.next(m) & valid);
+      }
+   }
+
+   const char*     text() const { return data; }
+   size_t          size() const { return len; }
+   size_t          count() const { return positions.size(); }
+   uint32_t        operator[](size_t i) const { return positions[i]; }
+   const uint32_t* begin() const { return positions.data(); }
+   const uint32_t* end() const { return positions.data() + positions.size(); }
+
+   /// True if the 64-byte block containing `offset` has no backslash, control or non-ASCII bytes.
+   /// Strings that only cross such blocks can be located with a plain search for the closing quote.
+   bool is_simple_block(size_t offset) const { return !complex_blocks[offset / block_size]; }
+
+ private:
+   struct masks {
+      uint64_t backslash = 0;
+      uint64_t quote     = 0;
+      uint64_t ws        = 0;
+      uint64_t op        = 0;
+      uint64_t control   = 0;
+      uint64_t high      = 0;
+      uint64_t zero      = 0;
+   };
+
+   // Carries the escape, string and scalar state from one block to the next
+   struct block_state {
+      uint64_t prev_escaped   = 0;
+      uint64_t prev_in_string = 0;
+      uint64_t prev_scalar    = 0;
+
+      uint64_t next(const masks& m) {
+         const uint64_t even_bits = 0x5555'5555'5555'5555ull;
+
+         // A character is escaped if it is preceded by an odd-length run of backslashes
+         uint64_t backslash       = m.backslash & ~prev_escaped;
+         uint64_t follows_escape  = backslash << 1 | prev_escaped;
+         uint64_t odd_starts      = backslash & ~even_bits & ~follows_escape;
+         uint64_t even_seq_starts = odd_starts + backslash;
+         prev_escaped             = even_seq_starts < odd_starts;
+         uint64_t escaped         = (even_bits ^ (even_seq_starts << 1)) & follows_escape;
+
+         // In-string mask: includes the opening quote, excludes the closing one
+         uint64_t quote     = m.quote & ~escaped;
+         uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+         prev_in_string     = uint64_t(int64_t(in_string) >> 63);
+
+         // Scalars and strings start wherever a non-structural, non-whitespace character follows
+         // structure or whitespace
+         uint64_t scalar          = ~(m.op | m.ws);
+         uint64_t nonquote_scalar = scalar & ~quote;
+         uint64_t follows_scalar  = nonquote_scalar << 1 | prev_scalar;
+         prev_scalar              = nonquote_scalar >> 63;
+         uint64_t string_tail     = in_string ^ quote;
+         return (m.op | (scalar & ~follows_scalar)) & ~string_tail;
+      }
+
+      static uint64_t prefix_xor(uint64_t x) {
+         x ^= x << 1;
+         x ^= x << 2;
+         x ^= x << 4;
+         x ^= x << 8;
+         x ^= x << 16;
+         x ^= x << 32;
+         return x;
+      }
+   };
+
+   void append_structurals(uint32_t base, uint64_t bits) {
+      if (!bits)
+         return;
+      size_t n = positions.size();
+      positions.resize(n + __builtin_popcountll(bits));
+      uint32_t* out = positions.data() + n;
+      while (bits) {
+         *out++ = base + __builtin_ctzll(bits);
+         bits &= bits - 1;
+      }
+   }
+
+#if defined(__SSE2__)
+   static void classify(const char* p, masks& m) {
+      const __m128i backslash = _mm_set1_epi8('\\');
+      const __m128i quote     = _mm_set1_epi8('"');
+      const __m128i space     = _mm_set1_epi8(' ');
+      const __m128i tab       = _mm_set1_epi8('\t');
+      const __m128i nl        = _mm_set1_epi8('\n');
+      const __m128i cr        = _mm_set1_epi8('\r');
+      const __m128i lower     = _mm_set1_epi8(0x20);
+      const __m128i open      = _mm_set1_epi8('{');
+      const __m128i close     = _mm_set1_epi8('}');
+      const __m128i colon     = _mm_set1_epi8(':');
+      const __m128i comma     = _mm_set1_epi8(',');
+      const __m128i max_ctrl  = _mm_set1_epi8(0x1f);
+      const __m128i zero      = _mm_setzero_si128();
+      for (int i = 0; i < 4; ++i) {
+         __m128i  x     = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16));
+         __m128i  fold  = _mm_or_si128(x, lower); // '[' -> '{', ']' -> '}'
+         int      shift = i * 16;
+         auto     bits  = [&](__m128i v) { return uint64_t(uint16_t(_mm_movemask_epi8(v))) << shift; };
+         m.backslash |= bits(_mm_cmpeq_epi8(x, backslash));
+         m.quote |= bits(_mm_cmpeq_epi8(x, quote));
+         m.ws |= bits(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, space), _mm_cmpeq_epi8(x, tab)),
+                                   _mm_or_si128(_mm_cmpeq_epi8(x, nl), _mm_cmpeq_epi8(x, cr))));
+         m.op |= bits(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(fold, open), _mm_cmpeq_epi8(fold, close)),
+                                   _mm_or_si128(_mm_cmpeq_epi8(x, colon), _mm_cmpeq_epi8(x, comma))));
+         m.control |= bits(_mm_cmpeq_epi8(_mm_max_epu8(x, max_ctrl), max_ctrl));
+         m.high |= bits(x);
+         m.zero |= bits(_mm_cmpeq_epi8(x, zero));
+      }
+   }
+#else
+   static void classify(const char* p, masks& m) {
+      for (int i = 0; i < 64; ++i) {
+         uint8_t  c   = p[i];
+         uint64_t bit = uint64_t(1) << i;
+         switch (c) {
+            case '\\': m.backslash |= bit; break;
+            case '"': m.quote |= bit; break;
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r': m.ws |= bit; break;
+            case '{':
+            case '}':
+            case '[':
+            case ']':
+            case ':':
+            case ',': m.op |= bit; break;
+         }
+         if (c < 0x20)
+            m.control |= bit;
+         if (c >= 0x80)
+            m.high |= bit;
+         if (!c)
+            m.zero |= bit;
+      }
+   }
+#endif
+
+   const char*           data = nullptr;
+   size_t                len  = 0;
+   std::vector<uint32_t> positions;
+   std::vector<uint8_t>  complex_blocks;
+};
+
+/// Length of the UTF-8 sequence starting at `p` if it is well formed (no overlong encodings,
+/// surrogates or code points above U+10FFFF), otherwise 0. `p` must be NUL-terminated.
+inline int utf8_sequence_length(const char* p) {
+   auto c0 = uint8_t(p[0]);
+   if (c0 < 0x80)
+      return 1;
+   auto cont = [&](int i) { return (uint8_t(p[i]) & 0xc0) == 0x80; };
+   auto c1   = uint8_t(p[1]);
+   if (c0 >= 0xc2 && c0 <= 0xdf)
+      return cont(1) ? 2 : 0;
+   if (c0 >= 0xe0 && c0 <= 0xef) {
+      if (!cont(1) || (c0 == 0xe0 && c1 < 0xa0) || (c0 == 0xed && c1 > 0x9f))
+         return 0;
+      return cont(2) ? 3 : 0;
+   }
+   if (c0 >= 0xf0 && c0 <= 0xf4) {
+      if (!cont(1) || (c0 == 0xf0 && c1 < 0x90) || (c0 == 0xf4 && c1 > 0x8f))
+         return 0;
+      return cont(2) && cont(3) ? 4 : 0;
+   }
+   return 0;
+}
+
+} // namespace eosio
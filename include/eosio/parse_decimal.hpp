@@ -0,0 +1,278 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace eosio {
+
+enum class parse_decimal_status {
+   ok,
+   invalid,
+   out_of_range,
+};
+
+namespace detail {
+
+   inline uint64_t load_8_chars(const char* p) {
+      uint64_t v;
+      memcpy(&v, p, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      v = __builtin_bswap64(v);
+#endif
+      return v;
+   }
+
+   // True if all 8 bytes are '0'..'9'
+   inline bool is_8_digits(uint64_t v) {
+      return ((v & 0xf0f0'f0f0'f0f0'f0f0ull) | (((v + 0x0606'0606'0606'0606ull) & 0xf0f0'f0f0'f0f0'f0f0ull) >> 4)) ==
+             0x3333'3333'3333'3333ull;
+   }
+
+   // Converts 8 ASCII digits (first digit in the lowest byte) with three multiplies
+   inline uint32_t parse_8_digits(uint64_t v) {
+      v -= 0x3030'3030'3030'3030ull;
+      v = (v * 10) + (v >> 8);
+      v = (((v & 0x0000'00ff'0000'00ffull) * (100 + (1000000ull << 32))) +
+           (((v >> 16) & 0x0000'00ff'0000'00ffull) * (1 + (10000ull << 32)))) >>
+          32;
+      return uint32_t(v);
+   }
+
+   inline constexpr uint64_t pow10_u64[] = {
+      1ull,
+      10ull,
+      100ull,
+      1000ull,
+      10000ull,
+      100000ull,
+      1000000ull,
+      10000000ull,
+      100000000ull,
+      1000000000ull,
+      10000000000ull,
+      100000000000ull,
+      1000000000000ull,
+      10000000000000ull,
+      100000000000000ull,
+      1000000000000000ull,
+      10000000000000000ull,
+      100000000000000000ull,
+      1000000000000000000ull,
+      10000000000000000000ull,
+   };
+
+   // Largest magnitudes, as decimal strings, indexed by log2(sizeof(T))
+   inline constexpr std::string_view max_unsigned[] = {
+      "255", "65535", "4294967295", "18446744073709551615", "340282366920938463463374607431768211455",
+   };
+   inline constexpr std::string_view max_signed[] = {
+      "127", "32767", "2147483647", "9223372036854775807", "170141183460469231731687303715884105727",
+   };
+   inline constexpr std::string_view max_negative[] = {
+      "128", "32768", "2147483648", "9223372036854775808", "170141183460469231731687303715884105728",
+   };
+
+   template <typename T>
+   constexpr int size_index() {
+      static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8 || sizeof(T) == 16);
+      return sizeof(T) == 1 ? 0 : sizeof(T) == 2 ? 1 : sizeof(T) == 4 ? 2 : sizeof(T) == 8 ? 3 : 4;
+   }
+
+   template <typename T>
+   struct make_unsigned_int {
+      using type = std::make_unsigned_t<T>;
+   };
+#ifndef ABIEOS_NO_INT128
+   template <>
+   struct make_unsigned_int<__int128> {
+      using type = unsigned __int128;
+   };
+   template <>
+   struct make_unsigned_int<unsigned __int128> {
+      using type = unsigned __int128;
+   };
+#endif
+
+   inline constexpr auto digit_pairs = [] {
+      std::array<char, 200> table{};
+      for (int i = 0; i < 100; ++i) {
+         table[2 * i]     = '0' + i / 10;
+         table[2 * i + 1] = '0' + i % 10;
+      }
+      return table;
+   }();
+
+   inline void write_2_digits(char* out, uint32_t value) { memcpy(out, &digit_pairs[2 * value], 2); }
+
+   // Number of decimal digits in v, at least 1
+   inline unsigned count_digits(uint64_t v) {
+      v |= 1;
+      unsigned t = (64 - __builtin_clzll(v)) * 1233 >> 12;
+      return t + (v >= pow10_u64[t]);
+   }
+
+   // Writes the digits of v so that they end just before end, two at a time. Returns the first digit.
+   template <typename T>
+   char* write_digits_backward(char* end, T v) {
+      while (v >= 100) {
+         end -= 2;
+         write_2_digits(end, uint32_t(v % 100));
+         v /= 100;
+      }
+      if (v >= 10) {
+         end -= 2;
+         write_2_digits(end, uint32_t(v));
+      } else {
+         *--end = '0' + v;
+      }
+      return end;
+   }
+
+   // Writes v < 10^19 as exactly 19 digits, zero-padded, ending just before end
+   inline void write_19_digits_backward(char* end, uint64_t v) {
+      char* begin = end - 19;
+      for (; end - begin > 1; end -= 2, v /= 100) write_2_digits(end - 2, v % 100);
+      *begin = '0' + v;
+   }
+
+} // namespace detail
+
+/// Returns the end of the run of ASCII digits starting at `p`
+inline const char* scan_decimal_digits(const char* p, const char* end) {
+   while (end - p >= 8 && detail::is_8_digits(detail::load_8_chars(p))) p += 8;
+   while (p != end && uint8_t(*p - '0') < 10) ++p;
+   return p;
+}
+
+/// Value of the digits in [p, end), which must all be digits and at most 19 of them
+inline uint64_t parse_decimal_digits(const char* p, const char* end) {
+   uint64_t v = 0;
+   while (end - p >= 8) {
+      v = v * 100000000 + detail::parse_8_digits(detail::load_8_chars(p));
+      p += 8;
+   }
+   while (p != end) v = v * 10 + uint64_t(*p++ - '0');
+   return v;
+}
+
+/// Parses a decimal magnitude from [p, end) without throwing. The value is checked against
+/// `limit` (the largest magnitude allowed, in decimal) before any arithmetic is done, so
+/// `f(pow10, chunk)` only needs to compute `value = value * pow10 + chunk` and never overflows.
+/// Chunks are at most 19 digits, so `pow10` is at most 10^19.
+///
+/// A digit run that is out of range is reported even if an invalid character follows it,
+/// matching the digit-at-a-time parsers this replaces.
+template <typename F>
+parse_decimal_status parse_decimal_chunks(const char* p, const char* end, std::string_view limit, F f) {
+   bool found = p != end && *p == '0';
+   while (p != end && *p == '0') ++p;
+   const char* digits_end = scan_decimal_digits(p, end);
+   size_t      n          = digits_end - p;
+   if (n > limit.size() || (n == limit.size() && memcmp(p, limit.data(), n) > 0))
+      return parse_decimal_status::out_of_range;
+   if (digits_end != end || !(found || n))
+      return parse_decimal_status::invalid;
+   size_t first = n % 19 ? n % 19 : 19;
+   if (n) {
+      f(detail::pow10_u64[first], parse_decimal_digits(p, p + first));
+      for (p += first; p != end; p += 19) f(detail::pow10_u64[19], parse_decimal_digits(p, p + 19));
+   }
+   return parse_decimal_status::ok;
+}
+
+/// Parses a decimal integer, with an optional leading '-' for signed types, into `result`.
+/// Works for 8 to 128 bit integers. `result` is left unchanged unless `ok` is returned.
+template <typename T>
+parse_decimal_status parse_decimal(T& result, std::string_view s) {
+   using U                  = typename detail::make_unsigned_int<T>::type;
+   constexpr bool is_signed = T(-1) < T(0);
+   const char*    p         = s.data();
+   const char*    end       = p + s.size();
+   bool           negative  = is_signed && p != end && *p == '-';
+   p += negative;
+
+   if constexpr (sizeof(T) <= 8) {
+      // Up to 19 characters fit in 64 bits, so all-digit input can be range checked after parsing.
+      // Anything else (including invalid input) takes the general path below.
+      size_t len = end - p;
+      if (len - 1 < 19) {
+         uint64_t    v      = 0;
+         const char* q      = p;
+         bool        digits = true;
+         for (; end - q >= 8; q += 8) {
+            uint64_t chunk = detail::load_8_chars(q);
+            if (!(digits = detail::is_8_digits(chunk)))
+               break;
+            v = v * 100000000 + detail::parse_8_digits(chunk);
+         }
+         for (; digits && q != end; ++q) {
+            unsigned d = uint8_t(*q - '0');
+            digits     = d < 10;
+            v          = v * 10 + d;
+         }
+         if (digits) {
+            uint64_t max = uint64_t(U(~U(0)) >> is_signed) + negative;
+            if (v > max)
+               return parse_decimal_status::out_of_range;
+            result = negative ? T(U(0) - U(v)) : T(v);
+            return parse_decimal_status::ok;
+         }
+      }
+   }
+
+   std::string_view limit = !is_signed ? detail::max_unsigned[detail::size_index<T>()]
+                            : negative ? detail::max_negative[detail::size_index<T>()]
+                                       : detail::max_signed[detail::size_index<T>()];
+   U    value  = 0;
+   auto status = parse_decimal_chunks(p, end, limit, [&](uint64_t pow10, uint64_t chunk) { //
+      value = U(value * pow10 + chunk);
+   });
+   if (status == parse_decimal_status::ok)
+      result = negative ? T(U(0) - value) : T(value);
+   return status;
+}
+
+/// Parses an amount written as `digits[.digits]` (the sign and symbol are handled by the caller)
+/// into an integer scaled by the number of fraction digits, which is stored in `precision`.
+/// Fails if the scaled amount is larger than `max_amount`.
+inline bool parse_decimal_amount(uint64_t& amount, uint8_t& precision, const char*& s, const char* end,
+                                 uint64_t max_amount) {
+   const char* int_begin  = s;
+   const char* int_end    = scan_decimal_digits(s, end);
+   const char* frac_begin = int_end;
+   const char* frac_end   = int_end;
+   s                      = int_end;
+   if (s != end && *s == '.') {
+      frac_begin = ++s;
+      frac_end = s = scan_decimal_digits(s, end);
+   }
+   size_t frac_digits = frac_end - frac_begin;
+   if (frac_digits > 255)
+      return false;
+   precision = uint8_t(frac_digits);
+
+   while (int_begin != int_end && *int_begin == '0') ++int_begin;
+   if ((int_end - int_begin) + frac_digits <= 18) {
+      amount = parse_decimal_digits(int_begin, int_end) * detail::pow10_u64[frac_digits] +
+               parse_decimal_digits(frac_begin, frac_end);
+      return amount <= max_amount;
+   }
+
+   uint64_t v     = 0;
+   auto     digit = [&](char c) {
+      return !__builtin_mul_overflow(v, 10, &v) && !__builtin_add_overflow(v, uint64_t(c - '0'), &v) && v <= max_amount;
+   };
+   for (auto p = int_begin; p != int_end; ++p)
+      if (!digit(*p))
+         return false;
+   for (auto p = frac_begin; p != frac_end; ++p)
+      if (!digit(*p))
+         return false;
+   amount = v;
+   return true;
+}
+
+} // namespace eosio
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "fixed_bin_size.hpp"
+#include "from_bin.hpp"
+#include "skip_bin.hpp"
+#include "to_bin.hpp"
+#include "types.hpp"
+#include <iterator>
+
+namespace eosio {
+
+/// A serialized std::vector<T> left in place. from_bin only finds where the elements end, using
+/// skip_bin, which reads length prefixes and the tags and flags of variants and optionals but no
+/// element data, and allocates nothing. The elements are decoded again on each iteration, and they
+/// point into the source buffer, which must outlive the view.
+template <typename T>
+class sequence_view {
+ public:
+   class iterator {
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using value_type        = T;
+      using difference_type   = std::ptrdiff_t;
+      using pointer           = const T*;
+      using reference         = const T&;
+
+      iterator() = default;
+      iterator(input_stream bin, uint32_t remaining) : bin{ bin }, remaining{ remaining } { load(); }
+
+      const T& operator*() const { return value; }
+      const T* operator->() const { return &value; }
+
+      iterator& operator++() {
+         --remaining;
+         load();
+         return *this;
+      }
+
+      bool operator==(const iterator& other) const { return remaining == other.remaining; }
+      bool operator!=(const iterator& other) const { return remaining != other.remaining; }
+
+    private:
+      void load() {
+         if (remaining)
+            from_bin(value, bin);
+      }
+
+      input_stream bin       = {};
+      uint32_t     remaining = 0;
+      T            value     = {};
+   };
+
+   sequence_view() = default;
+   sequence_view(input_stream elements, uint32_t count) : elements_{ elements }, count_{ count } {}
+
+   uint32_t size() const { return count_; }
+   bool     empty() const { return !count_; }
+
+   iterator begin() const { return { elements_, count_ }; }
+   iterator end() const { return {}; }
+
+   /// The serialized elements, without the leading count
+   input_stream elements() const { return elements_; }
+
+   std::vector<T> to_vector() const { return { begin(), end() }; }
+
+ private:
+   input_stream elements_ = {};
+   uint32_t     count_    = 0;
+};
+
+template <typename T>
+constexpr const char* get_type_name(sequence_view<T>*) {
+   return vector_type_name<T>.data();
+}
+
+template <typename T, typename S>
+void from_bin(sequence_view<T>& obj, S& stream) {
+   uint32_t count;
+   varuint32_from_bin(count, stream);
+   const char* begin = stream.get_pos();
+   if constexpr (fixed_bin_size_v<T> != 0) {
+      stream.skip(size_t(count) * fixed_bin_size_v<T>);
+   } else {
+      for (uint32_t i = 0; i < count; ++i) skip_bin((T*)nullptr, stream);
+   }
+   obj = sequence_view<T>{ input_stream{ begin, stream.get_pos() }, count };
+}
+
+template <typename T, typename S>
+void skip_bin(sequence_view<T>*, S& stream) {
+   skip_bin((std::vector<T>*)nullptr, stream);
+}
+
+template <typename T, typename S>
+void to_bin(const sequence_view<T>& obj, S& stream) {
+   varuint32_to_bin(obj.size(), stream);
+   if (obj.elements().remaining())
+      stream.write(obj.elements().pos, obj.elements().remaining());
+}
+
+template <typename T, typename S>
+void to_json(const sequence_view<T>& obj, S& stream) {
+   stream.write('[');
+   bool first = true;
+   for (auto& v : obj) {
+      if (first) {
+         increase_indent(stream);
+      } else {
+         stream.write(',');
+      }
+      write_newline(stream);
+      first = false;
+      to_json(v, stream);
+   }
+   if (!first) {
+      decrease_indent(stream);
+      write_newline(stream);
+   }
+   stream.write(']');
+}
+
+} // namespace eosio
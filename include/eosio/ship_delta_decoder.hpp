@@ -0,0 +1,146 @@
+#pragma once
+
+#include "ship_protocol.hpp"
+#include "to_json.hpp"
+#include "worker_pool.hpp"
+#include <array>
+#include <string_view>
+
+namespace eosio { namespace ship_protocol {
+
+   /// Every row type a table_delta can carry. Each alternative's type name is the table_delta
+   /// name of its rows.
+   using table_row = std::variant<account, account_metadata, code, contract_table, contract_row, contract_index64,
+                                  contract_index128, contract_index256, contract_index_double,
+                                  contract_index_long_double, key_value, global_property, generated_transaction,
+                                  protocol_state, permission, permission_link, resource_limits, resource_usage,
+                                  resource_limits_state, resource_limits_config>;
+
+   namespace detail {
+
+      // The names share long prefixes, so only the length, first and last two characters are hashed.
+      // Multiplying by the golden ratio and keeping the top bits spreads them over the slots.
+      constexpr size_t table_name_slot(std::string_view name, uint32_t seed) {
+         uint32_t key = uint32_t(name.size()) << 24 | uint32_t(uint8_t(name[0])) << 16 |
+                        uint32_t(uint8_t(name[name.size() - 2])) << 8 | uint8_t(name.back());
+         return ((key ^ seed) * 0x9e3779b1u) >> 26;
+      }
+
+      template <size_t N>
+      struct table_name_map {
+         static constexpr size_t size = 64; // must match the 6 bits table_name_slot keeps
+
+         std::array<std::string_view, N> names = {};
+         std::array<uint8_t, size>       slots = {}; // index + 1, or 0 for no name
+         uint32_t                        seed  = 0;
+      };
+
+      // Searches for a seed which hashes every name to its own slot
+      template <typename... Ts>
+      constexpr auto make_table_name_map(std::variant<Ts...>*) {
+         table_name_map<sizeof...(Ts)> map{ { get_type_name((Ts*)nullptr)... } };
+         for (;; ++map.seed) {
+            map.slots  = {};
+            bool clash = false;
+            for (size_t i = 0; i < map.names.size() && !clash; ++i) {
+               auto& slot = map.slots[table_name_slot(map.names[i], map.seed)];
+               clash      = slot;
+               slot       = i + 1;
+            }
+            if (!clash)
+               return map;
+         }
+      }
+
+      inline constexpr auto table_row_names = make_table_name_map((table_row*)nullptr);
+
+   } // namespace detail
+
+   /// Index of the table_row alternative for a table_delta name, or -1 for an unknown name. The
+   /// names are placed by a perfect hash found at compile time, so this is one hash and one compare.
+   inline int table_row_index(std::string_view name) {
+      auto& map = detail::table_row_names;
+      if (name.size() < 2)
+         return -1;
+      auto slot = map.slots[detail::table_name_slot(name, map.seed)];
+      return slot && map.names[slot - 1] == name ? slot - 1 : -1;
+   }
+
+   /// A row of a table_delta with its `present` flag as sent: 0 or 1 for table_delta_v0, and 0
+   /// (removed), 1 (old value) or 2 (new value) for table_delta_v1
+   template <typename T>
+   struct decoded_row {
+      uint8_t present = {};
+      T       data    = {};
+   };
+
+   /// The rows of one table_delta, in their original order. `name` points into the table_delta.
+   template <typename T>
+   struct decoded_table_delta {
+      std::string_view            name = {};
+      std::vector<decoded_row<T>> rows = {};
+   };
+
+   /// Decodes the rows of every delta into table_row, or into its json when T is std::string, with
+   /// deltas and rows in their original order. With a pool, the rows are cut into jobs of
+   /// `rows_per_job` which run across its threads. Throws on a delta with an unknown name and on a
+   /// row with bytes left over after its value.
+   template <typename T = table_row>
+   std::vector<decoded_table_delta<T>> decode_table_deltas(const std::vector<table_delta>& deltas,
+                                                           worker_pool* pool = nullptr, size_t rows_per_job = 256) {
+      static_assert(std::is_same_v<T, table_row> || std::is_same_v<T, std::string>,
+                    "decode_table_deltas decodes into table_row or std::string");
+      struct job {
+         size_t delta, begin, end;
+         int    index;
+      };
+      check(rows_per_job > 0, "rows_per_job must be positive");
+      std::vector<decoded_table_delta<T>> result(deltas.size());
+      std::vector<job>                    jobs;
+      for (size_t i = 0; i < deltas.size(); ++i) {
+         std::visit(
+               [&](auto& delta) {
+                  int index = table_row_index(delta.name);
+                  check(index >= 0, "unknown table_delta name: " + delta.name);
+                  result[i].name = delta.name;
+                  result[i].rows.resize(delta.rows.size());
+                  for (size_t b = 0; b < delta.rows.size(); b += rows_per_job)
+                     jobs.push_back({ i, b, std::min(b + rows_per_job, delta.rows.size()), index });
+               },
+               deltas[i]);
+      }
+
+      auto decode = [&](size_t j) {
+         auto& jb = jobs[j];
+         std::visit(
+               [&](auto& delta) {
+                  for (size_t r = jb.begin; r < jb.end; ++r) {
+                     auto& row   = delta.rows[r];
+                     auto& out   = result[jb.delta].rows[r];
+                     out.present = row.present;
+                     if (!row.data.remaining())
+                        continue;
+                     input_stream bin = row.data;
+                     eosio::dispatch_index<std::variant_size_v<table_row>>(jb.index, [&](auto i) {
+                        using alternative = std::variant_alternative_t<decltype(i)::value, table_row>;
+                        if constexpr (std::is_same_v<T, table_row>) {
+                           from_bin(out.data.template emplace<decltype(i)::value>(), bin);
+                        } else {
+                           alternative value;
+                           from_bin(value, bin);
+                           out.data = convert_to_json(value);
+                        }
+                     });
+                     check(!bin.remaining(), "extra data in table_delta row");
+                  }
+               },
+               deltas[jb.delta]);
+      };
+      if (pool)
+         pool->run(jobs.size(), decode);
+      else
+         for (size_t j = 0; j < jobs.size(); ++j) decode(j);
+      return result;
+   }
+
+}} // namespace eosio::ship_protocol
@@ -6,6 +6,7 @@
 #include "float.hpp"
 #include "name.hpp"
 #include "opaque.hpp"
+#include "skip_bin.hpp"
 #include "stream.hpp"
 #include "time.hpp"
 #include "varint.hpp"
@@ -1009,6 +1010,16 @@ namespace eosio {
       return from_bin(obj.recurse, stream);
    }
 
+   template <typename S, auto... Members>
+   void from_bin(ship_protocol::recurse_transaction_trace& obj, S& stream, skip_fields<Members...> skip) {
+      return from_bin(obj.recurse, stream, skip);
+   }
+
+   template <typename S>
+   void skip_bin(ship_protocol::recurse_transaction_trace*, S& stream) {
+      return skip_bin((ship_protocol::transaction_trace*)nullptr, stream);
+   }
+
    template <typename S>
    void to_json(const ship_protocol::recurse_transaction_trace& obj, S& stream) {
       return to_json(obj.recurse, stream);
@@ -0,0 +1,318 @@
+#pragma once
+
+#include "sequence_view.hpp"
+#include "ship_protocol.hpp"
+
+// Views of the block, trace, delta and permission types from ship_protocol.hpp: strings are
+// std::string_view and vectors are sequence_view, both pointing into the buffer they were decoded
+// from, so from_bin allocates nothing and the buffer must outlive them. Nested vectors are decoded
+// only when iterated. They serialize to the same binary and json as the originals. Types that never
+// allocate are shared with ship_protocol.
+namespace eosio { namespace ship_protocol { namespace view {
+
+   struct table_delta_v0 {
+      std::string_view      name = {};
+      sequence_view<row_v0> rows = {};
+   };
+
+   EOSIO_REFLECT(table_delta_v0, name, rows)
+
+   struct table_delta_v1 {
+      std::string_view      name = {};
+      sequence_view<row_v1> rows = {};
+   };
+
+   EOSIO_REFLECT(table_delta_v1, name, rows)
+
+   using table_delta = std::variant<table_delta_v0, table_delta_v1>;
+   constexpr const char* get_type_name(table_delta*) { return "table_delta"; }
+
+   struct action {
+      eosio::name                     account       = {};
+      eosio::name                     name          = {};
+      sequence_view<permission_level> authorization = {};
+      eosio::input_stream             data          = {};
+   };
+
+   EOSIO_REFLECT(action, account, name, authorization, data)
+
+   struct action_receipt_v0 {
+      eosio::name                          receiver        = {};
+      eosio::checksum256                   act_digest      = {};
+      uint64_t                             global_sequence = {};
+      uint64_t                             recv_sequence   = {};
+      sequence_view<account_auth_sequence> auth_sequence   = {};
+      eosio::varuint32                     code_sequence   = {};
+      eosio::varuint32                     abi_sequence    = {};
+   };
+
+   EOSIO_REFLECT(action_receipt_v0, receiver, act_digest, global_sequence, recv_sequence, auth_sequence, code_sequence,
+                 abi_sequence)
+
+   using action_receipt = std::variant<action_receipt_v0>;
+   constexpr const char* get_type_name(action_receipt*) { return "action_receipt"; }
+
+   struct action_trace_v0 {
+      eosio::varuint32                action_ordinal         = {};
+      eosio::varuint32                creator_action_ordinal = {};
+      std::optional<action_receipt>   receipt                = {};
+      eosio::name                     receiver               = {};
+      action                          act                    = {};
+      bool                            context_free           = {};
+      int64_t                         elapsed                = {};
+      std::string_view                console                = {};
+      sequence_view<account_delta>    account_ram_deltas     = {};
+      std::optional<std::string_view> except                 = {};
+      std::optional<uint64_t>         error_code             = {};
+   };
+
+   EOSIO_REFLECT(action_trace_v0, action_ordinal, creator_action_ordinal, receipt, receiver, act, context_free, elapsed,
+                 console, account_ram_deltas, except, error_code)
+
+   struct action_trace_v1 {
+      eosio::varuint32                action_ordinal         = {};
+      eosio::varuint32                creator_action_ordinal = {};
+      std::optional<action_receipt>   receipt                = {};
+      eosio::name                     receiver               = {};
+      action                          act                    = {};
+      bool                            context_free           = {};
+      int64_t                         elapsed                = {};
+      std::string_view                console                = {};
+      sequence_view<account_delta>    account_ram_deltas     = {};
+      sequence_view<account_delta>    account_disk_deltas    = {};
+      std::optional<std::string_view> except                 = {};
+      std::optional<uint64_t>         error_code             = {};
+      eosio::input_stream             return_value           = {};
+   };
+
+   EOSIO_REFLECT(action_trace_v1, action_ordinal, creator_action_ordinal, receipt, receiver, act, context_free, elapsed,
+                 console, account_ram_deltas, account_disk_deltas, except, error_code, return_value)
+
+   using action_trace = std::variant<action_trace_v0, action_trace_v1>;
+   constexpr const char* get_type_name(action_trace*) { return "action_trace"; }
+
+   struct prunable_data_partial {
+      sequence_view<eosio::signature> signatures;
+      sequence_view<segment_type>     context_free_segments;
+   };
+
+   struct prunable_data_full {
+      sequence_view<eosio::signature>    signatures;
+      sequence_view<eosio::input_stream> context_free_segments;
+   };
+
+   struct prunable_data_full_legacy {
+      sequence_view<eosio::signature> signatures;
+      eosio::input_stream             packed_context_free_data;
+   };
+
+   using prunable_data_t =
+         std::variant<prunable_data_full_legacy, prunable_data_none, prunable_data_partial, prunable_data_full>;
+   constexpr const char* get_type_name(prunable_data_t*) { return "prunable_data_t"; }
+
+   struct prunable_data_type {
+      prunable_data_t prunable_data;
+   };
+
+   EOSIO_REFLECT(prunable_data_type, prunable_data)
+   EOSIO_REFLECT(prunable_data_partial, signatures, context_free_segments)
+   EOSIO_REFLECT(prunable_data_full, signatures, context_free_segments)
+   EOSIO_REFLECT(prunable_data_full_legacy, signatures, packed_context_free_data)
+
+   struct partial_transaction_v0 {
+      eosio::time_point_sec              expiration             = {};
+      uint16_t                           ref_block_num          = {};
+      uint32_t                           ref_block_prefix       = {};
+      eosio::varuint32                   max_net_usage_words    = {};
+      uint8_t                            max_cpu_usage_ms       = {};
+      eosio::varuint32                   delay_sec              = {};
+      sequence_view<extension>           transaction_extensions = {};
+      sequence_view<eosio::signature>    signatures             = {};
+      sequence_view<eosio::input_stream> context_free_data      = {};
+   };
+
+   EOSIO_REFLECT(partial_transaction_v0, expiration, ref_block_num, ref_block_prefix, max_net_usage_words,
+                 max_cpu_usage_ms, delay_sec, transaction_extensions, signatures, context_free_data)
+
+   struct partial_transaction_v1 {
+      eosio::time_point_sec             expiration             = {};
+      uint16_t                          ref_block_num          = {};
+      uint32_t                          ref_block_prefix       = {};
+      eosio::varuint32                  max_net_usage_words    = {};
+      uint8_t                           max_cpu_usage_ms       = {};
+      eosio::varuint32                  delay_sec              = {};
+      sequence_view<extension>          transaction_extensions = {};
+      std::optional<prunable_data_type> prunable_data          = {};
+   };
+
+   EOSIO_REFLECT(partial_transaction_v1, expiration, ref_block_num, ref_block_prefix, max_net_usage_words,
+                 max_cpu_usage_ms, delay_sec, transaction_extensions, prunable_data)
+
+   using partial_transaction = std::variant<partial_transaction_v0, partial_transaction_v1>;
+   constexpr const char* get_type_name(partial_transaction*) { return "partial_transaction"; }
+
+   struct recurse_transaction_trace;
+
+   struct transaction_trace_v0 {
+      eosio::checksum256                       id                = {};
+      transaction_status                       status            = {};
+      uint32_t                                 cpu_usage_us      = {};
+      eosio::varuint32                         net_usage_words   = {};
+      int64_t                                  elapsed           = {};
+      uint64_t                                 net_usage         = {};
+      bool                                     scheduled         = {};
+      sequence_view<action_trace>              action_traces     = {};
+      std::optional<account_delta>             account_ram_delta = {};
+      std::optional<std::string_view>          except            = {};
+      std::optional<uint64_t>                  error_code        = {};
+      sequence_view<recurse_transaction_trace> failed_dtrx_trace = {};
+      std::optional<partial_transaction>       partial           = {};
+   };
+
+   EOSIO_REFLECT(transaction_trace_v0, id, status, cpu_usage_us, net_usage_words, elapsed, net_usage, scheduled,
+                 action_traces, account_ram_delta, except, error_code, failed_dtrx_trace, partial)
+
+   using transaction_trace = std::variant<transaction_trace_v0>;
+   constexpr const char* get_type_name(transaction_trace*) { return "transaction_trace"; }
+
+   struct recurse_transaction_trace {
+      transaction_trace recurse = {};
+   };
+
+   struct producer_schedule {
+      uint32_t                    version   = {};
+      sequence_view<producer_key> producers = {};
+   };
+
+   EOSIO_REFLECT(producer_schedule, version, producers)
+
+   struct packed_transaction_v0 {
+      sequence_view<eosio::signature> signatures               = {};
+      uint8_t                         compression              = {};
+      eosio::input_stream             packed_context_free_data = {};
+      eosio::input_stream             packed_trx               = {};
+   };
+
+   EOSIO_REFLECT(packed_transaction_v0, signatures, compression, packed_context_free_data, packed_trx)
+
+   struct packed_transaction {
+      uint8_t             compression   = {};
+      prunable_data_type  prunable_data = {};
+      eosio::input_stream packed_trx    = {};
+   };
+
+   EOSIO_REFLECT(packed_transaction, compression, prunable_data, packed_trx)
+
+   using transaction_variant_v0 = std::variant<eosio::checksum256, packed_transaction_v0>;
+   constexpr const char* get_type_name(transaction_variant_v0*) { return "transaction_variant_v0"; }
+
+   struct transaction_receipt_v0 : transaction_receipt_header {
+      transaction_variant_v0 trx = {};
+   };
+
+   EOSIO_REFLECT(transaction_receipt_v0, base transaction_receipt_header, trx)
+
+   using transaction_variant = std::variant<eosio::checksum256, packed_transaction>;
+   constexpr const char* get_type_name(transaction_variant*) { return "transaction_variant"; }
+
+   struct transaction_receipt : transaction_receipt_header {
+      transaction_variant trx = {};
+   };
+
+   EOSIO_REFLECT(transaction_receipt, base transaction_receipt_header, trx)
+
+   struct block_header {
+      eosio::block_timestamp           timestamp{};
+      eosio::name                      producer          = {};
+      uint16_t                         confirmed         = {};
+      eosio::checksum256               previous          = {};
+      eosio::checksum256               transaction_mroot = {};
+      eosio::checksum256               action_mroot      = {};
+      uint32_t                         schedule_version  = {};
+      std::optional<producer_schedule> new_producers     = {};
+      sequence_view<extension>         header_extensions = {};
+   };
+
+   EOSIO_REFLECT(block_header, timestamp, producer, confirmed, previous, transaction_mroot, action_mroot,
+                 schedule_version, new_producers, header_extensions)
+
+   struct signed_block_header : block_header {
+      eosio::signature producer_signature = {};
+   };
+
+   EOSIO_REFLECT(signed_block_header, base block_header, producer_signature)
+
+   struct signed_block_v0 : signed_block_header {
+      sequence_view<transaction_receipt_v0> transactions     = {};
+      sequence_view<extension>              block_extensions = {};
+   };
+
+   EOSIO_REFLECT(signed_block_v0, base signed_block_header, transactions, block_extensions)
+
+   struct signed_block_v1 : signed_block_header {
+      uint8_t                            prune_state      = {};
+      sequence_view<transaction_receipt> transactions     = {};
+      sequence_view<extension>           block_extensions = {};
+   };
+
+   EOSIO_REFLECT(signed_block_v1, base signed_block_header, prune_state, transactions, block_extensions)
+
+   using signed_block_variant = std::variant<signed_block_v0, signed_block_v1>;
+   constexpr const char* get_type_name(signed_block_variant*) { return "signed_block_variant"; }
+
+   struct authority {
+      uint32_t                               threshold = {};
+      sequence_view<key_weight>              keys      = {};
+      sequence_view<permission_level_weight> accounts  = {};
+      sequence_view<wait_weight>             waits     = {};
+   };
+
+   EOSIO_REFLECT(authority, threshold, keys, accounts, waits)
+
+   struct permission_v0 {
+      eosio::name       owner        = {};
+      eosio::name       name         = {};
+      eosio::name       parent       = {};
+      eosio::time_point last_updated = {};
+      authority         auth         = {};
+   };
+
+   EOSIO_REFLECT(permission_v0, owner, name, parent, last_updated, auth)
+
+   using permission = std::variant<permission_v0>;
+   constexpr const char* get_type_name(permission*) { return "permission"; }
+
+}}} // namespace eosio::ship_protocol::view
+
+namespace eosio {
+
+   template <typename S>
+   void to_bin(const ship_protocol::view::recurse_transaction_trace& obj, S& stream) {
+      return to_bin(obj.recurse, stream);
+   }
+
+   template <typename S>
+   void from_bin(ship_protocol::view::recurse_transaction_trace& obj, S& stream) {
+      return from_bin(obj.recurse, stream);
+   }
+
+   template <typename S>
+   void skip_bin(ship_protocol::view::recurse_transaction_trace*, S& stream) {
+      return skip_bin((ship_protocol::view::transaction_trace*)nullptr, stream);
+   }
+
+   template <typename S>
+   void to_json(const ship_protocol::view::recurse_transaction_trace& obj, S& stream) {
+      return to_json(obj.recurse, stream);
+   }
+
+   template <typename S>
+   void to_json(const sequence_view<ship_protocol::view::recurse_transaction_trace>& obj, S& stream) {
+      if (!obj.empty()) {
+         to_json(*obj.begin(), stream);
+      } else {
+         stream.write("null", 4);
+      }
+   }
+
+} // namespace eosio
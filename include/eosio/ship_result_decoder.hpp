@@ -0,0 +1,221 @@
+#pragma once
+
+#include "ship_protocol.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace eosio { namespace ship_protocol {
+
+   /// A get_blocks_result with its block, traces and deltas decoded. `message` holds the bytes the
+   /// decoded values point into (action data, row data, ...), so keep it alongside them.
+   struct decoded_blocks_result : get_blocks_result_base {
+      std::vector<char>                   message      = {};
+      std::optional<signed_block_variant> block        = {};
+      std::optional<signed_block_header>  block_header = {};
+      std::vector<transaction_trace>      traces       = {};
+      std::vector<table_delta>            deltas       = {};
+   };
+
+   /// Decodes serialized `result` messages holding get_blocks_result_v0, v1 or v2 on a pool of
+   /// worker threads. Each message is split into separate block, trace and delta jobs, so one large
+   /// block's traces decode alongside the next blocks. Results come out of pop() in the order their
+   /// messages went into push(). At most `max_in_flight` messages are held at once; push() waits for
+   /// pop() beyond that, so a producer which pushes and pops on one thread should check full() first.
+   /// A message which fails to decode, or has bytes left over in it or any of its parts, rethrows its
+   /// error from the pop() that would have returned it.
+   class blocks_result_decoder {
+    public:
+      explicit blocks_result_decoder(uint32_t num_threads   = std::max(1u, std::thread::hardware_concurrency()),
+                                     size_t   max_in_flight = 0)
+          : max_in_flight{ max_in_flight ? max_in_flight : 4 * size_t(std::max(1u, num_threads)) } {
+         for (uint32_t i = 0; i < std::max(1u, num_threads); ++i) workers.emplace_back([this] { run(); });
+      }
+
+      blocks_result_decoder(const blocks_result_decoder&) = delete;
+      blocks_result_decoder& operator=(const blocks_result_decoder&) = delete;
+
+      /// Stops the workers; results not yet popped are dropped
+      ~blocks_result_decoder() {
+         {
+            std::lock_guard<std::mutex> lock{ mutex };
+            stopping = true;
+         }
+         job_ready.notify_all();
+         for (auto& w : workers) w.join();
+      }
+
+      void push(std::vector<char> message) {
+         std::unique_lock<std::mutex> lock{ mutex };
+         check(!finished, "push() after finish()");
+         space_ready.wait(lock, [&] { return slots.size() < max_in_flight; });
+         slots.push_back(std::make_unique<slot>());
+         slots.back()->result.message = std::move(message);
+         jobs.push_back({ slots.back().get(), stage::split });
+         lock.unlock();
+         job_ready.notify_one();
+      }
+
+      /// Waits for the oldest message to finish decoding. Returns false once finish() has been
+      /// called and every message has been popped.
+      bool pop(decoded_blocks_result& result) {
+         std::unique_lock<std::mutex> lock{ mutex };
+         result_ready.wait(lock, [&] {
+            return (!slots.empty() && !slots.front()->pending) || (finished && slots.empty());
+         });
+         if (slots.empty())
+            return false;
+         auto s = std::move(slots.front());
+         slots.pop_front();
+         lock.unlock();
+         space_ready.notify_one();
+         if (s->error)
+            std::rethrow_exception(s->error);
+         result = std::move(s->result);
+         return true;
+      }
+
+      /// Marks the end of the input, so pop() returns false after the last result
+      void finish() {
+         {
+            std::lock_guard<std::mutex> lock{ mutex };
+            finished = true;
+         }
+         result_ready.notify_all();
+      }
+
+      bool full() const {
+         std::lock_guard<std::mutex> lock{ mutex };
+         return slots.size() >= max_in_flight;
+      }
+
+    private:
+      enum class stage { split, block, block_header, traces, deltas };
+
+      struct slot {
+         decoded_blocks_result result  = {};
+         uint32_t              version = 0;
+         input_stream          block   = {};
+         input_stream          header  = {};
+         input_stream          traces  = {};
+         input_stream          deltas  = {};
+         uint32_t              pending = 1;
+         std::exception_ptr    error   = {};
+      };
+
+      struct job {
+         slot* s;
+         stage st;
+      };
+
+      void run() {
+         std::unique_lock<std::mutex> lock{ mutex };
+         while (true) {
+            job_ready.wait(lock, [&] { return stopping || !jobs.empty(); });
+            if (stopping)
+               return;
+            auto j = jobs.front();
+            jobs.pop_front();
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+               execute(j);
+            } catch (...) { error = std::current_exception(); }
+            lock.lock();
+            if (error && !j.s->error)
+               j.s->error = error;
+            if (!--j.s->pending && j.s == slots.front().get())
+               result_ready.notify_all();
+         }
+      }
+
+      void execute(job j) {
+         auto& s = *j.s;
+         auto& r = s.result;
+         switch (j.st) {
+            case stage::split: return split(s);
+            case stage::block:
+               if (s.version == 0)
+                  r.block = signed_block_variant{ from_bin<signed_block_v0>(s.block) };
+               else
+                  from_bin(r.block.emplace(), s.block);
+               return check_end(s.block);
+            case stage::block_header: from_bin(r.block_header.emplace(), s.header); return check_end(s.header);
+            case stage::traces: from_bin(r.traces, s.traces); return check_end(s.traces);
+            case stage::deltas: from_bin(r.deltas, s.deltas); return check_end(s.deltas);
+         }
+      }
+
+      static void check_end(const input_stream& bin) {
+         check(!bin.remaining(), "extra data in get_blocks_result");
+      }
+
+      // Finds each part of the message and queues a job for every non-empty one
+      void split(slot& s) {
+         input_stream bin{ s.result.message };
+         varuint32_from_bin(s.version, bin);
+         check(s.version >= 1 && s.version <= 3, "not a get_blocks_result");
+         s.version -= 1;
+         from_bin(static_cast<get_blocks_result_base&>(s.result), bin);
+         if (s.version == 0) {
+            std::optional<input_stream> block, traces, deltas;
+            from_bin(block, bin);
+            from_bin(traces, bin);
+            from_bin(deltas, bin);
+            s.block  = block.value_or(input_stream{});
+            s.traces = traces.value_or(input_stream{});
+            s.deltas = deltas.value_or(input_stream{});
+         } else if (s.version == 1) {
+            bool present;
+            from_bin(present, bin);
+            auto begin = bin.pos;
+            if (present)
+               skip_bin<signed_block_variant>(bin);
+            s.block = { begin, bin.pos };
+            from_bin(s.traces, bin);
+            from_bin(s.deltas, bin);
+         } else {
+            from_bin(s.block, bin);
+            from_bin(s.header, bin);
+            from_bin(s.traces, bin);
+            from_bin(s.deltas, bin);
+         }
+         check_end(bin);
+
+         job  parts[4];
+         auto end = parts;
+         if (s.block.remaining())
+            *end++ = { &s, stage::block };
+         if (s.header.remaining())
+            *end++ = { &s, stage::block_header };
+         if (s.traces.remaining())
+            *end++ = { &s, stage::traces };
+         if (s.deltas.remaining())
+            *end++ = { &s, stage::deltas };
+         if (end != parts) {
+            {
+               std::lock_guard<std::mutex> lock{ mutex };
+               s.pending += end - parts;
+               jobs.insert(jobs.end(), parts, end);
+            }
+            job_ready.notify_all();
+         }
+      }
+
+      const size_t                      max_in_flight;
+      mutable std::mutex                mutex;
+      std::condition_variable           job_ready;
+      std::condition_variable           result_ready;
+      std::condition_variable           space_ready;
+      std::deque<std::unique_ptr<slot>> slots;
+      std::deque<job>                   jobs;
+      std::vector<std::thread>          workers;
+      bool                              stopping = false;
+      bool                              finished = false;
+   };
+
+}} // namespace eosio::ship_protocol
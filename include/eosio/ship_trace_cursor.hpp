@@ -0,0 +1,110 @@
+#pragma once
+
+#include "ship_protocol_view.hpp"
+
+namespace eosio { namespace ship_protocol {
+
+   /// The members of transaction_trace_v0 which come before action_traces
+   struct transaction_trace_header {
+      eosio::checksum256 id              = {};
+      transaction_status status          = {};
+      uint32_t           cpu_usage_us    = {};
+      eosio::varuint32   net_usage_words = {};
+      int64_t            elapsed         = {};
+      uint64_t           net_usage       = {};
+      bool               scheduled       = {};
+   };
+
+   EOSIO_REFLECT(transaction_trace_header, id, status, cpu_usage_us, net_usage_words, elapsed, net_usage, scheduled)
+
+   /// Walks a serialized std::vector<transaction_trace>, such as get_blocks_result's traces, one
+   /// action trace at a time without building the vectors. Each next() decodes one action into the
+   /// same ActionTrace object; members of a transaction after its action traces (account_ram_delta,
+   /// except, error_code, failed_dtrx_trace and partial) are stepped over with skip_bin. With the
+   /// default view::action_trace nothing is allocated, whatever the size of the block, and the
+   /// action points into `traces`, which must outlive it. With action_trace, string and vector
+   /// capacity is reused from one action to the next.
+   template <typename ActionTrace = view::action_trace>
+   class basic_trace_cursor {
+    public:
+      explicit basic_trace_cursor(input_stream traces) : bin{ traces } { varuint32_from_bin(transactions_left, bin); }
+
+      /// Moves to the next action trace. Returns false after the last one, and throws if bytes are
+      /// left over once the last transaction is done.
+      bool next() {
+         while (!actions_left) {
+            if (in_transaction)
+               finish_transaction();
+            if (!transactions_left) {
+               check(!bin.remaining(), "extra data in transaction traces");
+               return false;
+            }
+            start_transaction();
+         }
+         decode_action();
+         --actions_left;
+         ++action_num;
+         return true;
+      }
+
+      /// Skips the actions left in the current transaction; the following next() starts the next one
+      void skip_transaction() {
+         for (; actions_left; --actions_left) skip_bin<action_trace>(bin);
+      }
+
+      const transaction_trace_header& transaction() const { return header; }
+      const ActionTrace&              action() const { return act; }
+
+      /// Position of the current transaction in the vector and of the action within it
+      uint32_t transaction_index() const { return transaction_num - 1; }
+      uint32_t action_index() const { return action_num - 1; }
+
+    private:
+      void start_transaction() {
+         uint32_t index;
+         varuint32_from_bin(index, bin);
+         check(index == 0, convert_stream_error(stream_error::bad_variant_index));
+         from_bin(header, bin);
+         varuint32_from_bin(actions_left, bin);
+         --transactions_left;
+         ++transaction_num;
+         action_num     = 0;
+         in_transaction = true;
+      }
+
+      void finish_transaction() {
+         skip_bin<std::optional<account_delta>>(bin);
+         skip_bin<std::optional<std::string>>(bin);
+         skip_bin<std::optional<uint64_t>>(bin);
+         skip_bin<std::vector<recurse_transaction_trace>>(bin);
+         skip_bin<std::optional<partial_transaction>>(bin);
+         in_transaction = false;
+      }
+
+      // Decodes in place when the variant already holds the right alternative, so its members
+      // keep their capacity
+      void decode_action() {
+         uint32_t index;
+         varuint32_from_bin(index, bin);
+         check(index < std::variant_size_v<ActionTrace>, convert_stream_error(stream_error::bad_variant_index));
+         dispatch_index<std::variant_size_v<ActionTrace>>(index, [&](auto i) {
+            if (act.index() == i)
+               from_bin(std::get<decltype(i)::value>(act), bin);
+            else
+               from_bin(act.template emplace<decltype(i)::value>(), bin);
+         });
+      }
+
+      input_stream             bin               = {};
+      transaction_trace_header header            = {};
+      ActionTrace              act               = {};
+      uint32_t                 transactions_left = 0;
+      uint32_t                 actions_left      = 0;
+      uint32_t                 transaction_num   = 0;
+      uint32_t                 action_num        = 0;
+      bool                     in_transaction    = false;
+   };
+
+   using trace_cursor = basic_trace_cursor<>;
+
+}} // namespace eosio::ship_protocol
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "fixed_bin_size.hpp"
+#include "from_bin.hpp"
+#include "opaque.hpp"
+#include "variant_dispatch.hpp"
+#include "varint.hpp"
+
+namespace eosio {
+
+/// Advances `stream` past a serialized T without building one. Fixed-size values are skipped in one
+/// step; strings, byte blobs and vectors read only their length prefixes; optionals, variants and
+/// reflected structs recurse into their members. Anything else is decoded into a temporary and
+/// dropped. As with fixed_bin_size, reflected types with their own from_bin must overload this.
+template <typename T, typename S>
+void skip_bin(T*, S& stream);
+
+template <typename T, typename S>
+void skip_bin(S& stream) {
+   skip_bin((T*)nullptr, stream);
+}
+
+template <typename S>
+void skip_bin(input_stream*, S& stream) {
+   if constexpr (sizeof(size_t) >= 8) {
+      uint64_t size;
+      varuint64_from_bin(size, stream);
+      stream.skip(size);
+   } else {
+      uint32_t size;
+      varuint32_from_bin(size, stream);
+      stream.skip(size);
+   }
+}
+
+template <typename T, typename S>
+void skip_bin(opaque<T>*, S& stream) {
+   skip_bin((input_stream*)nullptr, stream);
+}
+
+template <typename S>
+void skip_bin(varuint32*, S& stream) {
+   uint32_t value;
+   varuint32_from_bin(value, stream);
+}
+
+template <typename S>
+void skip_bin(varint32*, S& stream) {
+   int32_t value;
+   varint32_from_bin(value, stream);
+}
+
+template <typename A, typename S>
+void skip_bin(std::basic_string<char, std::char_traits<char>, A>*, S& stream) {
+   uint32_t size;
+   varuint32_from_bin(size, stream);
+   stream.skip(size);
+}
+
+template <typename S>
+void skip_bin(std::string_view*, S& stream) {
+   uint32_t size;
+   varuint32_from_bin(size, stream);
+   stream.skip(size);
+}
+
+template <typename T, typename A, typename S>
+void skip_bin(std::vector<T, A>*, S& stream) {
+   if constexpr (has_bitwise_serialization<T>() && sizeof(size_t) >= 8) {
+      uint64_t size;
+      varuint64_from_bin(size, stream);
+      stream.check_available(size * sizeof(T));
+      stream.skip(size * sizeof(T));
+   } else if constexpr (fixed_bin_size_v<T> != 0) {
+      uint32_t size;
+      varuint32_from_bin(size, stream);
+      stream.skip(size_t(size) * fixed_bin_size_v<T>);
+   } else {
+      uint32_t size;
+      varuint32_from_bin(size, stream);
+      for (uint32_t i = 0; i < size; ++i) skip_bin((T*)nullptr, stream);
+   }
+}
+
+template <typename T, typename S>
+void skip_bin(std::optional<T>*, S& stream) {
+   bool present;
+   from_bin(present, stream);
+   if (present)
+      skip_bin((T*)nullptr, stream);
+}
+
+template <typename... Ts, typename S>
+void skip_bin(std::variant<Ts...>*, S& stream) {
+   uint32_t u;
+   varuint32_from_bin(u, stream);
+   check( u < sizeof...(Ts), convert_stream_error(stream_error::bad_variant_index) );
+   dispatch_index<sizeof...(Ts)>(u, [&](auto i) {
+      skip_bin((std::variant_alternative_t<decltype(i)::value, std::variant<Ts...>>*)nullptr, stream);
+   });
+}
+
+template <typename T, typename S>
+void skip_bin(T*, S& stream) {
+   if constexpr (fixed_bin_size_v<T> != 0) {
+      stream.skip(fixed_bin_size_v<T>);
+   } else if constexpr (reflection::has_for_each_field_v<T> && std::is_same_v<serialization_type<T>, void>) {
+      for_each_field<T>([&](const char*, auto member) {
+         skip_bin((std::decay_t<decltype(member(std::declval<T*>()))>*)nullptr, stream);
+      });
+   } else {
+      T temp;
+      from_bin(temp, stream);
+   }
+}
+
+/// Reflected members which from_bin(obj, stream, skip_fields<...>{}) steps over with skip_bin
+/// instead of decoding, e.g. skip_fields<&action_trace_v1::console, &action_trace_v1::return_value>.
+/// The list applies at every depth: vectors, optionals and variants pass it down to their elements,
+/// so one list can name members of several nested types. Fixed-size structs are always decoded
+/// whole, since skipping part of one saves nothing. Skipped members keep whatever value they had
+/// before the call.
+template <auto... Members>
+struct skip_fields {};
+
+namespace detail {
+
+   template <typename M1, typename M2>
+   constexpr bool same_member(M1 a, M2 b) {
+      if constexpr (std::is_same_v<M1, M2>)
+         return a == b;
+      else
+         return false;
+   }
+
+} // namespace detail
+
+template <typename T, typename S, auto... Members>
+void from_bin(T& obj, S& stream, skip_fields<Members...> skip);
+
+template <typename S, auto... Members>
+void from_bin(varuint32& obj, S& stream, skip_fields<Members...>) {
+   from_bin(obj, stream);
+}
+
+template <typename S, auto... Members>
+void from_bin(varint32& obj, S& stream, skip_fields<Members...>) {
+   from_bin(obj, stream);
+}
+
+template <typename T, typename A, typename S, auto... Members>
+void from_bin(std::vector<T, A>& v, S& stream, skip_fields<Members...> skip) {
+   if constexpr (has_bitwise_serialization<T>()) {
+      from_bin(v, stream);
+   } else {
+      uint32_t size;
+      varuint32_from_bin(size, stream);
+      v.resize(size);
+      for (size_t i = 0; i < size; ++i) {
+         from_bin(v[i], stream, skip);
+      }
+   }
+}
+
+template <typename T, typename S, auto... Members>
+void from_bin(std::optional<T>& obj, S& stream, skip_fields<Members...> skip) {
+   bool present;
+   from_bin(present, stream);
+   if (!present) {
+      obj.reset();
+      return;
+   }
+   obj.emplace();
+   from_bin(*obj, stream, skip);
+}
+
+template <typename... Ts, typename S, auto... Members>
+void from_bin(std::variant<Ts...>& obj, S& stream, skip_fields<Members...> skip) {
+   uint32_t u;
+   varuint32_from_bin(u, stream);
+   check( u < sizeof...(Ts), convert_stream_error(stream_error::bad_variant_index) );
+   dispatch_index<sizeof...(Ts)>(u, [&](auto i) { from_bin(obj.template emplace<decltype(i)::value>(), stream, skip); });
+}
+
+template <typename T, typename S, auto... Members>
+void from_bin(T& obj, S& stream, skip_fields<Members...> skip) {
+   if constexpr (fixed_bin_size_v<T> == 0 && reflection::has_for_each_field_v<T> &&
+                 std::is_same_v<serialization_type<T>, void>) {
+      eosio_for_each_field((T*)nullptr, [&](const char*, auto member) {
+         if constexpr (std::is_member_object_pointer_v<decltype(member((T*)nullptr))>) {
+            auto& field = obj.*member(&obj);
+            if constexpr ((detail::same_member(member((T*)nullptr), Members) || ...))
+               skip_bin(&field, stream);
+            else
+               from_bin(field, stream, skip);
+         }
+      });
+   } else {
+      from_bin(obj, stream);
+   }
+}
+
+} // namespace eosio
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "check.hpp"
+#include <functional>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -26,6 +28,7 @@ enum class stream_error {
    invalid_name_char13,
    name_too_long,
    json_writer_error, // !!!
+   write_error,
 }; // stream_error
 
 constexpr inline std::string_view convert_stream_error(stream_error e) {
@@ -44,6 +47,7 @@ constexpr inline std::string_view convert_stream_error(stream_error e) {
       case stream_error::invalid_name_char13:      return "thirteenth character in name cannot be a letter that comes after j";
       case stream_error::name_too_long:            return "string is too long to be a valid name";
       case stream_error::json_writer_error: return "Error writing json";
+      case stream_error::write_error:       return "Error writing to file descriptor";
          // clang-format on
 
       default: return "unknown";
@@ -91,6 +95,206 @@ struct vector_stream {
    }
 };
 
+/// Output stream which appends to a std::string or std::vector<char>, doubling it when full. Bytes
+/// past the write position are scratch space until finish() trims the container to what was written.
+/// If the stream grew the container well past that, finish() also gives the spare capacity back.
+template <typename Container>
+struct growable_stream {
+   Container& data;
+   char*      pos;
+   char*      end;
+   size_t     orig_capacity;
+
+   explicit growable_stream(Container& data, size_t reserve = 0) : data{ data }, orig_capacity{ data.capacity() } {
+      size_t size = data.size();
+      data.resize(size + (reserve ? reserve : 64));
+      pos = data.data() + size;
+      end = data.data() + data.size();
+   }
+
+   void write(char c) {
+      if (pos == end)
+         grow(1);
+      *pos++ = c;
+   }
+
+   void write(const void* src, std::size_t sz) {
+      if (sz > size_t(end - pos))
+         grow(sz);
+      memcpy(pos, src, sz);
+      pos += sz;
+   }
+
+   template <int Size>
+   void write(const char (&src)[Size]) {
+      write(src, Size);
+   }
+
+   template <typename T>
+   void write_raw(const T& v) {
+      write(&v, sizeof(v));
+   }
+
+   void finish() {
+      size_t used = pos - data.data();
+      data.resize(used);
+      if (data.capacity() > orig_capacity && data.capacity() - used > std::max(used, size_t(4096)))
+         data.shrink_to_fit();
+   }
+
+ private:
+   void grow(size_t n) {
+      size_t used = pos - data.data();
+      data.resize(std::max(data.size() * 2, used + n));
+      pos = data.data() + used;
+      end = data.data() + data.size();
+   }
+};
+
+/// How convert_to_json, format_json and convert_to_bin size their output
+enum class convert_mode {
+   automatic,   ///< chosen per type by the convert function
+   two_pass,    ///< serialize into a size_stream, then again into an exactly-sized buffer
+   single_pass, ///< serialize once into a growable_stream which reserves convert_size_hint
+};
+
+/// Output size of the most recent single-pass conversion of a T on this thread. The next one reserves
+/// this much up front, so a stream of similar objects grows its buffer once at most.
+template <typename T>
+inline thread_local size_t convert_size_hint = 0;
+
+/// Fixed-size pages for segmented_stream, kept for reuse once a stream is done with them. At most
+/// `max_free_pages` are kept; pages returned beyond that are freed, so one large output doesn't pin
+/// its memory for the life of the pool.
+class page_pool {
+ public:
+   static constexpr size_t default_page_size      = 64 * 1024;
+   static constexpr size_t default_max_free_pages = 16;
+
+   explicit page_pool(size_t page_size = default_page_size, size_t max_free_pages = default_max_free_pages)
+       : page_size_{ page_size }, max_free_pages_{ max_free_pages } {}
+
+   size_t page_size() const { return page_size_; }
+   size_t free_pages() const { return free_.size(); }
+
+   std::unique_ptr<char[]> get() {
+      if (free_.empty())
+         return std::unique_ptr<char[]>(new char[page_size_]);
+      auto page = std::move(free_.back());
+      free_.pop_back();
+      return page;
+   }
+
+   void put(std::unique_ptr<char[]> page) {
+      if (free_.size() < max_free_pages_)
+         free_.push_back(std::move(page));
+   }
+
+   static page_pool& thread_default() {
+      static thread_local page_pool pool;
+      return pool;
+   }
+
+ private:
+   size_t                               page_size_;
+   size_t                               max_free_pages_;
+   std::vector<std::unique_ptr<char[]>> free_;
+};
+
+/// Output stream which writes into a list of pages from a page_pool. Growing never copies what was
+/// already written. The result is read back as segments, or copied out once. If on_page_full is set,
+/// it is called with the stream instead of adding a page once every page is full, and the pages are
+/// then reused; it must consume the segments, e.g. by writing them out.
+struct segmented_stream {
+   page_pool&                                    pool;
+   std::vector<std::unique_ptr<char[]>>          pages;
+   char*                                         pos;
+   char*                                         end;
+   std::function<void(const segmented_stream&)> on_page_full;
+
+   explicit segmented_stream(page_pool& pool = page_pool::thread_default()) : pool{ pool } { add_page(); }
+   segmented_stream(const segmented_stream&) = delete;
+   segmented_stream& operator=(const segmented_stream&) = delete;
+   ~segmented_stream() {
+      for (auto& page : pages) pool.put(std::move(page));
+   }
+
+   void write(char c) {
+      if (pos == end)
+         add_page();
+      *pos++ = c;
+   }
+
+   void write(const void* src, std::size_t sz) {
+      auto s = reinterpret_cast<const char*>(src);
+      while (sz > size_t(end - pos)) {
+         size_t n = end - pos;
+         memcpy(pos, s, n);
+         pos += n;
+         s += n;
+         sz -= n;
+         add_page();
+      }
+      memcpy(pos, s, sz);
+      pos += sz;
+   }
+
+   template <int Size>
+   void write(const char (&src)[Size]) {
+      write(src, Size);
+   }
+
+   template <typename T>
+   void write_raw(const T& v) {
+      write(&v, sizeof(v));
+   }
+
+   size_t size() const { return (pages.size() - 1) * pool.page_size() + (pos - pages.back().get()); }
+
+   /// Calls f(const char* data, size_t size) for each non-empty segment, in order
+   template <typename F>
+   void for_each_segment(F&& f) const {
+      for (size_t i = 0; i + 1 < pages.size(); ++i) f(pages[i].get(), pool.page_size());
+      if (pos != pages.back().get())
+         f(pages.back().get(), size_t(pos - pages.back().get()));
+   }
+
+   std::vector<std::string_view> segments() const {
+      std::vector<std::string_view> result;
+      for_each_segment([&](const char* data, size_t size) { result.emplace_back(data, size); });
+      return result;
+   }
+
+   /// Copies everything written to dest, which must have room for size() bytes
+   void copy_to(char* dest) const {
+      for_each_segment([&](const char* data, size_t size) {
+         memcpy(dest, data, size);
+         dest += size;
+      });
+   }
+
+   void clear() {
+      while (pages.size() > 1) {
+         pool.put(std::move(pages.back()));
+         pages.pop_back();
+      }
+      pos = pages.back().get();
+      end = pos + pool.page_size();
+   }
+
+ private:
+   void add_page() {
+      if (on_page_full && !pages.empty()) {
+         on_page_full(*this);
+         clear();
+         return;
+      }
+      pages.push_back(pool.get());
+      pos = pages.back().get();
+      end = pos + pool.page_size();
+   }
+};
+
 struct fixed_buf_stream {
    char* pos;
    char* end;
@@ -119,6 +323,28 @@ struct fixed_buf_stream {
    }
 };
 
+// Writes through a bare pointer, for use once the caller has made room for everything it writes
+struct unchecked_output_stream {
+   char* pos;
+
+   void write(char c) { *pos++ = c; }
+
+   void write(const void* src, std::size_t sz) {
+      memcpy(pos, src, sz);
+      pos += sz;
+   }
+
+   template <int Size>
+   void write(const char (&src)[Size]) {
+      write(src, Size);
+   }
+
+   template <typename T>
+   void write_raw(const T& v) {
+      write(&v, sizeof(v));
+   }
+};
+
 struct size_stream {
    size_t size = 0;
 
@@ -165,6 +391,15 @@ struct pretty_stream : Base {
    std::vector<char> current_indent;
 };
 
+template <typename S>
+inline constexpr bool is_pretty_stream_v = false;
+
+template <typename S>
+inline constexpr bool is_pretty_stream_v<pretty_stream<S>> = true;
+
+template <bool Pretty, typename S>
+using maybe_pretty_stream = std::conditional_t<Pretty, pretty_stream<S>, S>;
+
 template <typename S>
 void increase_indent(pretty_stream<S>& s) {
    s.current_indent.resize(s.current_indent.size() + s.indent_size, ' ');
@@ -232,4 +467,24 @@ struct input_stream {
    }
 };
 
+// Reads through a bare pointer, for use once the caller has checked that everything it reads is
+// available
+struct unchecked_input_stream {
+   const char* pos;
+
+   auto get_pos() const { return pos; }
+
+   void read(void* dest, size_t size) {
+      memcpy(dest, pos, size);
+      pos += size;
+   }
+
+   template <typename T>
+   void read_raw(T& dest) {
+      read(&dest, sizeof(dest));
+   }
+
+   void skip(size_t size) { pos += size; }
+};
+
 } // namespace eosio
@@ -99,7 +99,12 @@ void from_json(time_point& obj, S& stream) {
 
 template <typename S>
 void to_json(const time_point& obj, S& stream) {
-   return to_json(eosio::microseconds_to_str(obj.elapsed._count), stream);
+   // Timestamps never need escaping
+   char buf[timestamp_chars + 2];
+   buf[0] = '"';
+   eosio::microseconds_to_chars(obj.elapsed._count, buf + 1, thread_timestamp_date_cache());
+   buf[timestamp_chars + 1] = '"';
+   stream.write(buf, sizeof(buf));
 }
 
 /**
@@ -178,7 +183,7 @@ void from_json(time_point_sec& obj, S& stream) {
 
 template <typename S>
 void to_json(const time_point_sec& obj, S& stream) {
-   return to_json(eosio::microseconds_to_str(uint64_t(obj.utc_seconds) * 1'000'000), stream);
+   return to_json(time_point(obj), stream);
 }
 
 /**
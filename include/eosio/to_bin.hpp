@@ -1,8 +1,10 @@
 #pragma once
 
 #include <deque>
+#include "fixed_bin_size.hpp"
 #include "for_each_field.hpp"
 #include "stream.hpp"
+#include "variant_dispatch.hpp"
 #include <list>
 #include <map>
 #include <optional>
@@ -56,8 +58,8 @@ void to_bin(std::string_view sv, S& stream) {
    stream.write(sv.data(), sv.size());
 }
 
-template <typename S>
-void to_bin(const std::string& s, S& stream) {
+template <typename A, typename S>
+void to_bin(const std::basic_string<char, std::char_traits<char>, A>& s, S& stream) {
    to_bin(std::string_view{ s }, stream);
 }
 
@@ -116,8 +118,8 @@ void to_bin(const T (&obj)[N], S& stream) {
    }
 }
 
-template <typename T, typename S>
-void to_bin(const std::vector<T>& obj, S& stream) {
+template <typename T, typename A, typename S>
+void to_bin(const std::vector<T, A>& obj, S& stream) {
    varuint32_to_bin(obj.size(), stream);
    if constexpr (has_bitwise_serialization<T>()) {
       stream.write(reinterpret_cast<const char*>(obj.data()), obj.size() * sizeof(T));
@@ -169,8 +171,9 @@ void to_bin(const std::optional<T>& obj, S& stream) {
 
 template <typename... Ts, typename S>
 void to_bin(const std::variant<Ts...>& obj, S& stream) {
+   check( !obj.valueless_by_exception(), convert_stream_error(stream_error::bad_variant_index) );
    varuint32_to_bin(obj.index(), stream);
-   std::visit([&](auto& x) { return to_bin(x, stream); }, obj);
+   dispatch_index<sizeof...(Ts)>(obj.index(), [&](auto i) { to_bin(*std::get_if<decltype(i)::value>(&obj), stream); });
 }
 
 template <int i, typename T, typename S>
@@ -188,15 +191,38 @@ void to_bin(const std::tuple<Ts...>& obj, S& stream) {
 
 template <typename T, std::size_t N, typename S>
 void to_bin(const std::array<T, N>& obj, S& stream) {
-   for (const T& elem : obj) {
-      to_bin(elem, stream);
+   if constexpr (has_bitwise_serialization<T>()) {
+      stream.write(reinterpret_cast<const char*>(obj.data()), N * sizeof(T));
+   } else {
+      for (const T& elem : obj) {
+         to_bin(elem, stream);
+      }
    }
 }
 
+template <typename T>
+void fixed_size_to_bin(const T& obj, char* dest) {
+   unchecked_output_stream unchecked{ dest };
+   for_each_field(obj, [&](auto& member) {
+      to_bin(member, unchecked);
+   });
+}
+
 template <typename T, typename S>
 void to_bin(const T& obj, S& stream) {
+   constexpr size_t fixed_size = fixed_bin_size_v<T>;
    if constexpr (has_bitwise_serialization<T>()) {
       stream.write(reinterpret_cast<const char*>(&obj), sizeof(obj));
+   } else if constexpr (fixed_size && std::is_same_v<S, size_stream>) {
+      stream.size += fixed_size;
+   } else if constexpr (fixed_size && std::is_same_v<S, fixed_buf_stream>) {
+      // One bounds check, or one resize, for the whole struct
+      check( fixed_size <= size_t(stream.end - stream.pos), convert_stream_error(stream_error::overrun) );
+      fixed_size_to_bin(obj, stream.pos);
+      stream.pos += fixed_size;
+   } else if constexpr (fixed_size && std::is_same_v<S, vector_stream>) {
+      stream.data.resize(stream.data.size() + fixed_size);
+      fixed_size_to_bin(obj, stream.data.data() + stream.data.size() - fixed_size);
    } else {
       for_each_field(obj, [&](auto& member) {
          to_bin(member, stream);
@@ -204,21 +230,35 @@ void to_bin(const T& obj, S& stream) {
    }
 }
 
+/// Types with a fixed_bin_size are written straight into an exactly-sized buffer whatever the mode.
+/// Measuring binary output is cheap next to growing a buffer, so automatic is otherwise two_pass.
 template <typename T>
-void convert_to_bin(const T& t, std::vector<char>& bin) {
-   size_stream ss;
-   to_bin(t, ss);
+void convert_to_bin(const T& t, std::vector<char>& bin, convert_mode mode = convert_mode::automatic) {
    auto orig_size = bin.size();
-   bin.resize(orig_size + ss.size);
-   fixed_buf_stream fbs(bin.data() + orig_size, ss.size);
-   to_bin(t, fbs);
-   check( fbs.pos == fbs.end, convert_stream_error(stream_error::underrun) );
+   if constexpr (fixed_bin_size_v<T> != 0) {
+      bin.resize(orig_size + fixed_bin_size_v<T>);
+      fixed_buf_stream fbs(bin.data() + orig_size, fixed_bin_size_v<T>);
+      to_bin(t, fbs);
+      check( fbs.pos == fbs.end, convert_stream_error(stream_error::underrun) );
+   } else if (mode != convert_mode::single_pass) {
+      size_stream ss;
+      to_bin(t, ss);
+      bin.resize(orig_size + ss.size);
+      fixed_buf_stream fbs(bin.data() + orig_size, ss.size);
+      to_bin(t, fbs);
+      check( fbs.pos == fbs.end, convert_stream_error(stream_error::underrun) );
+   } else {
+      growable_stream<std::vector<char>> gs(bin, convert_size_hint<T>);
+      to_bin(t, gs);
+      gs.finish();
+      convert_size_hint<T> = bin.size() - orig_size;
+   }
 }
 
 template <typename T>
-std::vector<char> convert_to_bin(const T& t) {
+std::vector<char> convert_to_bin(const T& t, convert_mode mode = convert_mode::automatic) {
    std::vector<char> result;
-   convert_to_bin(t, result);
+   convert_to_bin(t, result, mode);
    return result;
 }
 
@@ -3,8 +3,10 @@
 #include <cmath>
 #include "for_each_field.hpp"
 #include "fpconv.h"
+#include "parse_decimal.hpp"
 #include "stream.hpp"
 #include "types.hpp"
+#include "variant_dispatch.hpp"
 #include <limits>
 #include <optional>
 #include <rapidjson/encodings.h>
@@ -29,53 +31,118 @@ struct stream_adaptor {
    int  idx = 0;
 };
 
+namespace detail {
+
+   // 16 bytes of a string, classified together
+   typedef uint8_t json_chunk __attribute__((vector_size(16)));
+
+   // Returns the first byte in [begin, end) which can't be copied as is: quote, backslash, control
+   // characters and anything outside of printable ascii
+   inline const char* find_json_special(const char* begin, const char* end) {
+      for (; end - begin >= 16; begin += 16) {
+         json_chunk v;
+         memcpy(&v, begin, 16);
+         json_chunk special = (json_chunk)((v < 0x20) | (v >= 0x7f) | (v == '"') | (v == '\\'));
+         uint64_t   words[2];
+         memcpy(words, &special, 16);
+         if (words[0])
+            return begin + __builtin_ctzll(words[0]) / 8;
+         if (words[1])
+            return begin + 8 + __builtin_ctzll(words[1]) / 8;
+      }
+      while (begin != end && (unsigned char)(*begin) >= 32 && (unsigned char)(*begin) < 127 && *begin != '"' &&
+             *begin != '\\')
+         ++begin;
+      return begin;
+   }
+
+   // Returns the length of the well-formed utf-8 sequence at p, or 0 if there isn't one. p must
+   // point to a byte >= 0x80.
+   inline size_t utf8_sequence_size(const unsigned char* p, const unsigned char* end) {
+      auto cont = [&](size_t i, unsigned char lo, unsigned char hi) {
+         return end - p > ptrdiff_t(i) && p[i] >= lo && p[i] <= hi;
+      };
+      unsigned char c = *p;
+      if (c >= 0xC2 && c <= 0xDF)
+         return cont(1, 0x80, 0xBF) ? 2 : 0;
+      if (c >= 0xE0 && c <= 0xEF) {
+         unsigned char lo = c == 0xE0 ? 0xA0 : 0x80;
+         unsigned char hi = c == 0xED ? 0x9F : 0xBF;
+         return cont(1, lo, hi) && cont(2, 0x80, 0xBF) ? 3 : 0;
+      }
+      if (c >= 0xF0 && c <= 0xF4) {
+         unsigned char lo = c == 0xF0 ? 0x90 : 0x80;
+         unsigned char hi = c == 0xF4 ? 0x8F : 0xBF;
+         return cont(1, lo, hi) && cont(2, 0x80, 0xBF) && cont(3, 0x80, 0xBF) ? 4 : 0;
+      }
+      return 0;
+   }
+
+   // Returns the end of the run of well-formed, non-ascii utf-8 sequences starting at begin
+   inline const char* skip_utf8(const char* begin, const char* end) {
+      auto p = reinterpret_cast<const unsigned char*>(begin);
+      auto e = reinterpret_cast<const unsigned char*>(end);
+      while (p != e && *p >= 0x80) {
+         auto size = utf8_sequence_size(p, e);
+         if (!size)
+            break;
+         p += size;
+      }
+      return reinterpret_cast<const char*>(p);
+   }
+
+} // namespace detail
+
 // Replaces any invalid utf-8 bytes with ?
 template <typename S>
 void to_json(std::string_view sv, S& stream) {
    stream.write('"');
-   auto begin = sv.begin();
-   auto end   = sv.end();
+   auto begin = sv.data();
+   auto end   = begin + sv.size();
    while (begin != end) {
-      auto pos = begin;
-      while (pos != end && *pos != '"' && *pos != '\\' && (unsigned char)(*pos) >= 32 && *pos != 127) ++pos;
-      while (begin != pos) {
-         stream_adaptor s2(begin, static_cast<std::size_t>(pos - begin));
-         if (rapidjson::UTF8<>::Validate(s2, s2)) {
-            stream.write(begin, s2.idx);
-            begin += s2.idx;
+      auto pos = detail::find_json_special(begin, end);
+      if (begin != pos)
+         stream.write(begin, pos - begin);
+      begin = pos;
+      if (begin == end)
+         break;
+      if ((unsigned char)(*begin) >= 0x80) {
+         pos = detail::skip_utf8(begin, end);
+         if (begin != pos) {
+            stream.write(begin, pos - begin);
+            begin = pos;
          } else {
             ++begin;
             stream.write('?');
          }
+         continue;
       }
-      if (begin != end) {
-         if (*begin == '"') {
-            stream.write("\\\"", 2);
-         } else if (*begin == '\\') {
-            stream.write("\\\\", 2);
-         } else if (*begin == '\b') {
-            stream.write("\\b", 2);
-         } else if (*begin == '\f') {
-            stream.write("\\f", 2);
-         } else if (*begin == '\n') {
-            stream.write("\\n", 2);
-         } else if (*begin == '\r') {
-            stream.write("\\r", 2);
-         } else if (*begin == '\t') {
-            stream.write("\\t", 2);
-         } else {
-            stream.write("\\u00", 4);
-            stream.write(hex_digits[(unsigned char)(*begin) >> 4]);
-            stream.write(hex_digits[(unsigned char)(*begin) & 15]);
-         }
-         ++begin;
+      if (*begin == '"') {
+         stream.write("\\\"", 2);
+      } else if (*begin == '\\') {
+         stream.write("\\\\", 2);
+      } else if (*begin == '\b') {
+         stream.write("\\b", 2);
+      } else if (*begin == '\f') {
+         stream.write("\\f", 2);
+      } else if (*begin == '\n') {
+         stream.write("\\n", 2);
+      } else if (*begin == '\r') {
+         stream.write("\\r", 2);
+      } else if (*begin == '\t') {
+         stream.write("\\t", 2);
+      } else {
+         char buf[6] = { '\\', 'u', '0', '0', hex_digits[(unsigned char)(*begin) >> 4],
+                         hex_digits[(unsigned char)(*begin) & 15] };
+         stream.write(buf, 6);
       }
+      ++begin;
    }
    stream.write('"');
 }
 
-template <typename S>
-void to_json(const std::string& s, S& stream) {
+template <typename A, typename S>
+void to_json(const std::basic_string<char, std::char_traits<char>, A>& s, S& stream) {
    to_json(std::string_view{ s }, stream);
 }
 
@@ -118,22 +185,54 @@ struct make_unsigned<unsigned __int128> {
 template <typename T>
 using make_unsigned_t = typename make_unsigned<T>::type;
 
+// Writes value in decimal and returns the end. The length is computed first so the digits are written
+// in place, two at a time; 128-bit values are split into 64-bit chunks of 19 digits.
 template <typename T>
 char* int_to_decimal(T value, char* buffer) {
-   char* pos = buffer;
-   auto uvalue = make_unsigned_t<T>(value);
-   bool neg    = value < 0;
-   if (neg)
+   char* pos    = buffer;
+   auto  uvalue = make_unsigned_t<T>(value);
+   if (value < 0) {
       uvalue = -uvalue;
-   
-   do {
-      *pos++ = '0' + (uvalue % 10);
-      uvalue /= 10;
-   } while (uvalue);
-
-   if (neg)
       *pos++ = '-';
-   std::reverse(buffer, pos);
+   }
+   if constexpr (sizeof(T) == 1) {
+      if (uvalue >= 100) {
+         *pos++ = '0' + uvalue / 100;
+         uvalue %= 100;
+      } else if (uvalue < 10) {
+         *pos++ = '0' + uvalue;
+         return pos;
+      }
+      detail::write_2_digits(pos, uvalue);
+      pos += 2;
+   } else if constexpr (sizeof(T) <= 4) {
+      pos += detail::count_digits(uvalue);
+      detail::write_digits_backward(pos, uint32_t(uvalue));
+   } else if constexpr (sizeof(T) == 8) {
+      pos += detail::count_digits(uvalue);
+      detail::write_digits_backward(pos, uvalue);
+   } else {
+      constexpr uint64_t chunk = detail::pow10_u64[19];
+      if (uvalue <= std::numeric_limits<uint64_t>::max()) {
+         pos += detail::count_digits(uint64_t(uvalue));
+         detail::write_digits_backward(pos, uint64_t(uvalue));
+         return pos;
+      }
+      uint64_t low = uint64_t(uvalue % chunk);
+      uvalue /= chunk;
+      if (uvalue < chunk) {
+         pos += detail::count_digits(uint64_t(uvalue)) + 19;
+         detail::write_19_digits_backward(pos, low);
+         detail::write_digits_backward(pos - 19, uint64_t(uvalue));
+      } else {
+         uint64_t middle = uint64_t(uvalue % chunk);
+         uint64_t high   = uint64_t(uvalue / chunk);
+         pos += detail::count_digits(high) + 38;
+         detail::write_19_digits_backward(pos, low);
+         detail::write_19_digits_backward(pos - 19, middle);
+         detail::write_digits_backward(pos - 38, high);
+      }
+   }
    return pos;
 }
 
@@ -203,8 +302,8 @@ void to_json(const gpb::FileDescriptorSet& fds, S& stream) {
 
 // clang-format on
 
-template <typename T, typename S>
-void to_json(const std::vector<T>& obj, S& stream) {
+template <typename T, typename A, typename S>
+void to_json(const std::vector<T, A>& obj, S& stream) {
    stream.write('[');
    bool first = true;
    for (auto& v : obj) {
@@ -256,16 +355,58 @@ void to_json(const std::optional<T>& obj, S& stream) {
    }
 }
 
+namespace detail {
+
+   // `["name",` for each alternative of variant<T...>, built at compile time. Type names never need
+   // escaping. Alternative i's prefix is [offsets[i], offsets[i + 1]) of `data`.
+   template <typename... T>
+   struct variant_json_prefixes {
+      static constexpr auto offsets = [] {
+         std::array<size_t, sizeof...(T) + 1> result{};
+         size_t                               i = 0;
+         for (std::string_view name : { std::string_view{ get_type_name((T*)nullptr) }... }) {
+            result[i + 1] = result[i] + name.size() + 4;
+            ++i;
+         }
+         return result;
+      }();
+
+      static constexpr auto data = [] {
+         std::array<char, offsets.back()> result{};
+         size_t                           pos = 0;
+         for (std::string_view name : { std::string_view{ get_type_name((T*)nullptr) }... }) {
+            result[pos++] = '[';
+            result[pos++] = '"';
+            for (char c : name) result[pos++] = c;
+            result[pos++] = '"';
+            result[pos++] = ',';
+         }
+         return result;
+      }();
+   };
+
+} // namespace detail
+
 template <typename... T, typename S>
 void to_json(const std::variant<T...>& obj, S& stream) {
-   stream.write('[');
-   increase_indent(stream);
-   write_newline(stream);
-   std::visit(
-      [&](const auto& t) { to_json(get_type_name((std::decay_t<decltype(t)>*)nullptr), stream); }, obj);
-   stream.write(',');
-   write_newline(stream);
-   std::visit([&](auto& x) { return to_json(x, stream); }, obj);
+   check( !obj.valueless_by_exception(), convert_stream_error(stream_error::bad_variant_index) );
+   using prefixes = detail::variant_json_prefixes<T...>;
+   dispatch_index<sizeof...(T)>(obj.index(), [&](auto i) {
+      constexpr size_t index  = decltype(i)::value;
+      const char*      prefix = prefixes::data.data() + prefixes::offsets[index];
+      constexpr size_t size   = prefixes::offsets[index + 1] - prefixes::offsets[index];
+      if constexpr (!is_pretty_stream_v<S>) {
+         stream.write(prefix, size);
+      } else {
+         stream.write('[');
+         increase_indent(stream);
+         write_newline(stream);
+         stream.write(prefix + 1, size - 2);
+         stream.write(',');
+         write_newline(stream);
+      }
+      to_json(*std::get_if<index>(&obj), stream);
+   });
    decrease_indent(stream);
    write_newline(stream);
    stream.write(']');
@@ -279,12 +420,76 @@ void to_json(const std::variant<T...>& obj, S& stream) {
       using value_type = T;
    };
 
+namespace detail {
+
+   // The keys of T's reflected fields as they appear in compact json, built at compile time: `{"a":`
+   // for the first field and `,"b":` for each one after, back to back in `data`. Field i's key is
+   // [offsets[i], offsets[i + 1]).
+   template <typename T>
+   struct json_keys {
+      static constexpr size_t count = [] {
+         size_t n = 0;
+         for_each_field<T>([&](const char*, auto) { ++n; });
+         return n;
+      }();
+
+      static constexpr size_t size = [] {
+         size_t n = 0;
+         for_each_field<T>([&](const char* name, auto) {
+            for (n += 4; *name; ++name) ++n;
+         });
+         return n;
+      }();
+
+      static constexpr auto offsets = [] {
+         std::array<size_t, count + 1> result{};
+         size_t                        i = 0;
+         for_each_field<T>([&](const char* name, auto) {
+            result[i + 1] = result[i] + 4;
+            for (; *name; ++name) ++result[i + 1];
+            ++i;
+         });
+         return result;
+      }();
+
+      static constexpr auto data = [] {
+         std::array<char, size> result{};
+         size_t                 pos = 0;
+         for_each_field<T>([&](const char* name, auto) {
+            // Member names are identifiers, so never need escaping
+            result[pos] = pos ? ',' : '{';
+            result[++pos] = '"';
+            for (++pos; *name; ++name) result[pos++] = *name;
+            result[pos++] = '"';
+            result[pos++] = ':';
+         });
+         return result;
+      }();
+   };
+
+} // namespace detail
+
+// Empty optionals are written as null rather than skipped; abi serialization expects every field
 template <typename T, typename S>
 void to_json(const T& t, S& stream) {
-   bool         first = true;
-   stream.write('{');
-   eosio::for_each_field<T>([&](const char* name, auto&& member) {
-       auto addfield = [&]() {
+   if constexpr (!is_pretty_stream_v<S>) {
+      // Compact output: each key, with the brace or comma before it, is one fixed-size write
+      using keys = detail::json_keys<T>;
+      if constexpr (keys::count == 0) {
+         stream.write("{}", 2);
+      } else {
+         size_t i = 0;
+         eosio::for_each_field<T>([&](const char*, auto&& member) {
+            stream.write(keys::data.data() + keys::offsets[i], keys::offsets[i + 1] - keys::offsets[i]);
+            ++i;
+            to_json(member(&t), stream);
+         });
+         stream.write('}');
+      }
+   } else {
+      bool first = true;
+      stream.write('{');
+      eosio::for_each_field<T>([&](const char* name, auto&& member) {
          if (first) {
             increase_indent(stream);
             first = false;
@@ -295,24 +500,13 @@ void to_json(const T& t, S& stream) {
          to_json(name, stream);
          write_colon(stream);
          to_json(member(&t), stream);
-      };
-
-      auto m = member(&t);
-      using member_type = std::decay_t<decltype(m)>;
-      if constexpr ( not is_std_optional<member_type>::value ) {
-         addfield();
-      } else {
-         // !!! Skipping empty optionals breaks the tests, because
-         // abi serialization can't handle it.
-         if( !!m || true )
-            addfield();
+      });
+      if (!first) {
+         decrease_indent(stream);
+         write_newline(stream);
       }
-   });
-   if (!first) {
-      decrease_indent(stream);
-      write_newline(stream);
+      stream.write('}');
    }
-   stream.write('}');
 }
 
 template <typename S>
@@ -344,26 +538,35 @@ template <typename S> void to_json(long double value, S& stream) {
 
 #endif
 
-template <typename T>
-std::string convert_to_json(const T& t) {
-   size_stream ss;
-   to_json(t, ss);
-   std::string      result(ss.size, 0);
-   fixed_buf_stream fbs(result.data(), result.size());
-   to_json(t, fbs);
-   check( fbs.pos == fbs.end, convert_stream_error(stream_error::underrun) );
+template <bool Pretty, typename T>
+std::string convert_to_json_impl(const T& t, convert_mode mode) {
+   std::string result;
+   if (mode == convert_mode::two_pass) {
+      maybe_pretty_stream<Pretty, size_stream> ss;
+      to_json(t, ss);
+      result.resize(ss.size);
+      maybe_pretty_stream<Pretty, fixed_buf_stream> fbs(result.data(), result.size());
+      to_json(t, fbs);
+      check( fbs.pos == fbs.end, convert_stream_error(stream_error::underrun) );
+   } else {
+      maybe_pretty_stream<Pretty, growable_stream<std::string>> gs(result, convert_size_hint<T>);
+      to_json(t, gs);
+      gs.finish();
+      convert_size_hint<T> = result.size();
+   }
    return result;
 }
 
+/// Formatting json is costly enough that measuring first, which formats everything twice, never
+/// pays for itself. automatic is always single_pass.
 template <typename T>
-std::string format_json(const T& t) {
-   pretty_stream<size_stream> ss;
-   to_json(t, ss);
-   std::string                     result(ss.size, 0);
-   pretty_stream<fixed_buf_stream> fbs(result.data(), result.size());
-   to_json(t, fbs);
-   check( fbs.pos == fbs.end, convert_stream_error(stream_error::underrun) );
-   return result;
+std::string convert_to_json(const T& t, convert_mode mode = convert_mode::automatic) {
+   return convert_to_json_impl<false>(t, mode);
+}
+
+template <typename T>
+std::string format_json(const T& t, convert_mode mode = convert_mode::automatic) {
+   return convert_to_json_impl<true>(t, mode);
 }
 
 } // namespace eosio
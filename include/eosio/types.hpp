@@ -88,8 +88,8 @@ constexpr const char* get_type_name(const std::array<T,S>*) { return array_type_
 template <typename T>
 constexpr auto optional_type_name = append_type_name<T>("?");
 
-template <typename T>
-constexpr const char* get_type_name(std::vector<T>*) {
+template <typename T, typename A>
+constexpr const char* get_type_name(std::vector<T, A>*) {
    return vector_type_name<T>.data();
 }
 
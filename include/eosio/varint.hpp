@@ -204,6 +204,9 @@ struct unsigned_int {
 using varuint32 = unsigned_int;
 EOSIO_REFLECT(varuint32, value);
 
+template <>
+struct fixed_bin_size<varuint32> : std::integral_constant<size_t, 0> {};
+
 template <typename F>
 void convert(const varuint32& src, uint32_t& dst, F&& chooser) {
    dst = src.value;
@@ -424,6 +427,9 @@ struct signed_int {
 using varint32 = signed_int;
 EOSIO_REFLECT(varint32, value);
 
+template <>
+struct fixed_bin_size<varint32> : std::integral_constant<size_t, 0> {};
+
 template <typename S>
 void from_bin(varint32& obj, S& stream) {
    return varint32_from_bin(obj.value, stream);
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace eosio {
+
+/// Threads for fork-join loops: run(n, f) calls f(0) ... f(n - 1) on the workers and the calling
+/// thread, which claim indexes one at a time, and returns once every call is done. The first
+/// exception thrown by f is rethrown from run(). Calls to run() from several threads take turns.
+class worker_pool {
+ public:
+   /// `num_threads` counts the thread which calls run(), so 1 runs everything on the caller
+   explicit worker_pool(uint32_t num_threads = std::max(1u, std::thread::hardware_concurrency())) {
+      for (uint32_t i = 1; i < num_threads; ++i) workers.emplace_back([this] { work(); });
+   }
+
+   worker_pool(const worker_pool&) = delete;
+   worker_pool& operator=(const worker_pool&) = delete;
+
+   ~worker_pool() {
+      {
+         std::lock_guard<std::mutex> lock{ mutex };
+         stopping = true;
+      }
+      start.notify_all();
+      for (auto& w : workers) w.join();
+   }
+
+   uint32_t num_threads() const { return workers.size() + 1; }
+
+   template <typename F>
+   void run(size_t n, F&& f) {
+      if (n <= 1 || workers.empty()) {
+         for (size_t i = 0; i < n; ++i) f(i);
+         return;
+      }
+      std::lock_guard<std::mutex> run_lock{ run_mutex };
+      {
+         std::lock_guard<std::mutex> lock{ mutex };
+         fn     = const_cast<void*>(static_cast<const void*>(&f));
+         call   = [](void* fn, size_t i) { (*static_cast<std::remove_reference_t<F>*>(fn))(i); };
+         count  = n;
+         next   = 0;
+         active = workers.size();
+         error  = nullptr;
+         ++generation;
+      }
+      start.notify_all();
+      claim();
+      std::unique_lock<std::mutex> lock{ mutex };
+      done.wait(lock, [&] { return !active; });
+      if (error)
+         std::rethrow_exception(std::exchange(error, nullptr));
+   }
+
+ private:
+   using call_fn = void (*)(void*, size_t);
+
+   void claim() {
+      for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+         try {
+            call(fn, i);
+         } catch (...) {
+            std::lock_guard<std::mutex> lock{ mutex };
+            if (!error)
+               error = std::current_exception();
+         }
+      }
+   }
+
+   void work() {
+      uint64_t                     seen = 0;
+      std::unique_lock<std::mutex> lock{ mutex };
+      while (true) {
+         start.wait(lock, [&] { return stopping || generation != seen; });
+         if (stopping)
+            return;
+         seen = generation;
+         lock.unlock();
+         claim();
+         lock.lock();
+         if (!--active)
+            done.notify_one();
+      }
+   }
+
+   std::mutex               run_mutex;
+   std::mutex               mutex;
+   std::condition_variable  start;
+   std::condition_variable  done;
+   std::vector<std::thread> workers;
+   void*                    fn         = nullptr;
+   call_fn                  call       = nullptr;
+   size_t                   count      = 0;
+   std::atomic<size_t>      next       = 0;
+   size_t                   active     = 0;
+   uint64_t                 generation = 0;
+   std::exception_ptr       error      = nullptr;
+   bool                     stopping   = false;
+};
+
+} // namespace eosio
@@ -1,5 +1,6 @@
 #include <eosio/abi.hpp>
 #include <eosio/abieos.hpp>
+#include <eosio/fd_stream.hpp>
 using namespace eosio;
 
 namespace {
@@ -283,11 +284,11 @@ const abi_serializer* const eosio::optional_abi_serializer = &abi_serializer_for
 const abi_serializer* const eosio::szbytes_abi_serializer = &abi_serializer_for< ::abieos::pseudo_szbytes>;
 
 std::vector<char> eosio::abi_type::json_to_bin_reorderable(std::string_view json, std::function<void()> f) const {
-   abieos::jvalue tmp;
-   abieos::json_to_jvalue(tmp, json, f);
+   abieos::json_to_bin_converter converter;
+   converter.reorder = true;
    std::vector<char> result;
-   abieos::json_to_bin(result, this, tmp, f);
-   return result; 
+   converter.convert(result, this, json, false, f);
+   return result;
 }
 
 std::vector<char> eosio::abi_type::json_to_bin(std::string_view json) const {
@@ -296,13 +297,67 @@ std::vector<char> eosio::abi_type::json_to_bin(std::string_view json) const {
    return result;
 }
 
+namespace {
+struct json_to_bin_batch_converter {
+   const eosio::abi_type*           type;
+   eosio::json_to_bin_batch_result& result;
+   abieos::json_to_bin_converter    converter;
+
+   json_to_bin_batch_converter(const eosio::abi_type* type, eosio::json_to_bin_batch_result& result)
+       : type(type), result(result) {
+      result.bin.clear();
+      result.items.clear();
+      result.failed = 0;
+   }
+
+   void operator()(std::string_view json) {
+      auto&  item  = result.items.emplace_back();
+      size_t start = result.bin.size();
+      try {
+         item.size   = converter.convert(result.bin, type, json, true, [] {});
+         item.offset = result.bin.size() - item.size;
+      } catch (std::exception& e) {
+         result.bin.resize(start);
+         item.error = e.what();
+         ++result.failed;
+      }
+   }
+};
+} // namespace
+
+void eosio::abi_type::json_to_bin_batch(json_to_bin_batch_result& result, const std::string_view* json,
+                                        size_t count) const {
+   json_to_bin_batch_converter convert(this, result);
+   result.items.reserve(count);
+   for (size_t i = 0; i < count; ++i) convert(json[i]);
+}
+
+void eosio::abi_type::json_to_bin_ndjson(json_to_bin_batch_result& result, std::string_view ndjson) const {
+   json_to_bin_batch_converter convert(this, result);
+   while (!ndjson.empty()) {
+      auto line = ndjson.substr(0, ndjson.find('\n'));
+      ndjson.remove_prefix(std::min(line.size() + 1, ndjson.size()));
+      if (!line.empty() && line.back() == '\r')
+         line.remove_suffix(1);
+      if (!line.empty())
+         convert(line);
+   }
+}
+
 std::string eosio::abi_type::bin_to_json(eosio::input_stream bin) const {
-   std::string result;
-   abieos::bin_to_json(bin, this, result, []() {});
+   static thread_local name_json_cache name_cache;
+   std::string                         result;
+   abieos::bin_to_json(bin, this, result, []() {}, &name_cache);
    check(bin.pos == bin.end, "Extra data");
    return result;
 }
 
+void eosio::abi_type::bin_to_json(eosio::input_stream bin, fd_stream& out) const {
+   static thread_local name_json_cache name_cache;
+   abieos::bin_to_json(bin, this, out, []() {}, &name_cache);
+   check(bin.pos == bin.end, "Extra data");
+}
+
 std::string eosio::abi::convert_to_json(const char* type, eosio::input_stream bin) {
    std::string result;
    if (strncmp("protobuf::", type, sizeof("protobuf::") - 1) != 0) {
@@ -11,6 +11,7 @@ struct abieos_context_s {
     std::string last_error_buffer{};
     std::string result_str{};
     std::vector<char> result_bin{};
+    eosio::json_to_bin_batch_result batch{};
 
     std::map<name, abi> contracts{};
 };
@@ -260,6 +261,60 @@ extern "C" abieos_bool abieos_json_to_bin_reorderable(abieos_context* context, u
     });
 }
 
+template <typename F>
+int json_to_bin_batch(abieos_context* context, uint64_t contract, const char* type, F f) {
+    fix_null_str(type);
+    return handle_exceptions(context, -1, [&]() -> int {
+        context->last_error = "json parse error";
+        context->batch.items.clear();
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end()) {
+            set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+            return -1;
+        }
+        auto t = contract_it->second.get_type(type);
+        context->batch.bin.swap(context->result_bin);
+        f(t, context->batch);
+        context->batch.bin.swap(context->result_bin);
+        return int(context->batch.items.size());
+    });
+}
+
+extern "C" int abieos_json_to_bin_ndjson(abieos_context* context, uint64_t contract, const char* type,
+                                         const char* ndjson, size_t size) {
+    if (!ndjson)
+        size = 0;
+    return json_to_bin_batch(context, contract, type, [&](const abi_type* t, auto& batch) {
+        t->json_to_bin_ndjson(batch, {ndjson, size});
+    });
+}
+
+extern "C" int abieos_json_to_bin_batch(abieos_context* context, uint64_t contract, const char* type,
+                                        const char* const* json, const size_t* sizes, size_t count) {
+    return json_to_bin_batch(context, contract, type, [&](const abi_type* t, auto& batch) {
+        std::vector<std::string_view> docs;
+        docs.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            docs.emplace_back(json[i] ? json[i] : "", json[i] ? sizes[i] : 0);
+        t->json_to_bin_batch(batch, docs.data(), docs.size());
+    });
+}
+
+extern "C" abieos_bool abieos_get_batch_item(abieos_context* context, size_t index, size_t* offset, size_t* size) {
+    return handle_exceptions(context, false, [&] {
+        if (index >= context->batch.items.size())
+            return set_error(context, "batch index is out of range");
+        auto& item = context->batch.items[index];
+        if (!item.error.empty())
+            return set_error(context, item.error);
+        if (offset)
+            *offset = item.offset;
+        if (size)
+            *size = item.size;
+        return true;
+    });
+}
+
 extern "C" const char* abieos_bin_to_json(abieos_context* context, uint64_t contract, const char* type,
                                           const char* data, size_t size) {
     fix_null_str(type);
@@ -0,0 +1,1315 @@
+// Microbenchmarks for the serialization hot paths. Not part of ctest; build in Release and run
+// abieos_benchmark directly. Where a routine was replaced by a faster one, the previous version is
+// kept here as the baseline so the gain stays measurable.
+
+#include <eosio/abi.hpp>
+#include <eosio/asset.hpp>
+#include <eosio/abieos.hpp>
+#include <eosio/abieos_numeric.hpp>
+#include <eosio/abieos_ripemd160.hpp>
+#include <eosio/base58.hpp>
+#include <eosio/chain_conversions.hpp>
+#include <eosio/crypto.hpp>
+#include <eosio/fd_stream.hpp>
+#include <eosio/from_json.hpp>
+#include <eosio/name.hpp>
+#include <eosio/ship_delta_decoder.hpp>
+#include <eosio/ship_protocol.hpp>
+#include <eosio/ship_protocol_arena.hpp>
+#include <eosio/ship_protocol_view.hpp>
+#include <eosio/ship_result_decoder.hpp>
+#include <eosio/ship_trace_cursor.hpp>
+#include <eosio/time.hpp>
+#include <eosio/to_json.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+volatile uint64_t sink;
+
+// Runs f for at least 200ms and prints the time per call
+template <typename F>
+void bench(const char* name, size_t items_per_call, F&& f) {
+   using clock = std::chrono::steady_clock;
+   uint64_t calls = 0;
+   auto     start = clock::now();
+   auto     end   = start;
+   do {
+      for (int i = 0; i < 16; ++i) f();
+      calls += 16;
+      end = clock::now();
+   } while (end - start < std::chrono::milliseconds(200));
+   double ns = std::chrono::duration<double, std::nano>(end - start).count() / (calls * items_per_call);
+   printf("%-48s %10.2f ns/item\n", name, ns);
+}
+
+std::vector<std::string> random_integers(size_t count, unsigned max_digits, bool allow_negative) {
+   std::mt19937_64          rng(1);
+   std::vector<std::string> result;
+   for (size_t i = 0; i < count; ++i) {
+      std::string s;
+      if (allow_negative && rng() % 2)
+         s += '-';
+      unsigned digits = 1 + rng() % max_digits;
+      s += char('1' + rng() % 9);
+      for (unsigned d = 1; d < digits; ++d) s += char('0' + rng() % 10);
+      result.push_back(std::move(s));
+   }
+   return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// integer parsing
+///////////////////////////////////////////////////////////////////////////////
+
+// Digit-at-a-time parser previously used by from_json_int
+template <typename T>
+bool baseline_parse_int(T& result, std::string_view r) {
+   auto pos   = r.data();
+   auto end   = pos + r.size();
+   bool found = false;
+   result     = 0;
+   T limit;
+   T sign;
+   if (std::is_signed_v<T> && pos != end && *pos == '-') {
+      ++pos;
+      sign  = -1;
+      limit = std::numeric_limits<T>::min();
+   } else {
+      sign  = 1;
+      limit = std::numeric_limits<T>::max();
+   }
+   while (pos != end && *pos >= '0' && *pos <= '9') {
+      T digit = (*pos++ - '0');
+      if (std::is_signed_v<T> && (-sign * limit + digit) / 10 > -sign * result)
+         return false;
+      if (!std::is_signed_v<T> && (limit - digit) / 10 < result)
+         return false;
+      result = result * 10 + sign * digit;
+      found  = true;
+   }
+   return pos == end && found;
+}
+
+// Byte-array parser previously used by decimal_to_binary
+void baseline_decimal_to_binary(std::array<uint8_t, 16>& result, std::string_view s) {
+   memset(result.begin(), 0, result.size());
+   for (auto& src_digit : s) {
+      uint8_t carry = src_digit - '0';
+      for (auto& result_byte : result) {
+         int x       = result_byte * 10 + carry;
+         result_byte = x;
+         carry       = x >> 8;
+      }
+   }
+}
+
+// Digit-at-a-time formatter previously used by int_to_json
+template <typename T>
+char* baseline_int_to_decimal(T value, char* buffer) {
+   char* pos    = buffer;
+   auto  uvalue = eosio::make_unsigned_t<T>(value);
+   bool  neg    = value < 0;
+   if (neg)
+      uvalue = -uvalue;
+   do {
+      *pos++ = '0' + (uvalue % 10);
+      uvalue /= 10;
+   } while (uvalue);
+   if (neg)
+      *pos++ = '-';
+   std::reverse(buffer, pos);
+   return pos;
+}
+
+template <typename T>
+void bench_int(const char* name, unsigned max_digits) {
+   auto values = random_integers(1024, max_digits, T(-1) < T(0));
+   bench((std::string(name) + " baseline").c_str(), values.size(), [&] {
+      T r;
+      for (auto& v : values) {
+         baseline_parse_int(r, v);
+         sink += uint64_t(r);
+      }
+   });
+   bench((std::string(name) + " parse_decimal").c_str(), values.size(), [&] {
+      T r{};
+      for (auto& v : values) {
+         eosio::parse_decimal(r, v);
+         sink += uint64_t(r);
+      }
+   });
+
+   std::vector<T> parsed(values.size());
+   for (size_t i = 0; i < values.size(); ++i) eosio::parse_decimal(parsed[i], values[i]);
+   char buf[48];
+   bench((std::string(name) + " format baseline").c_str(), parsed.size(), [&] {
+      for (auto v : parsed) sink += baseline_int_to_decimal(v, buf) - buf;
+   });
+   bench((std::string(name) + " int_to_decimal").c_str(), parsed.size(), [&] {
+      for (auto v : parsed) sink += eosio::int_to_decimal(v, buf) - buf;
+   });
+}
+
+void bench_integers() {
+   bench_int<uint8_t>("uint8", 3);
+   bench_int<int32_t>("int32", 9);
+   bench_int<uint64_t>("uint64", 19);
+   bench_int<int64_t>("int64", 18);
+#ifndef ABIEOS_NO_INT128
+   bench_int<__int128>("int128", 38);
+   bench_int<unsigned __int128>("uint128", 38);
+#endif
+
+   auto values = random_integers(1024, 38, false);
+   bench("decimal_to_binary<16> baseline", values.size(), [&] {
+      std::array<uint8_t, 16> r;
+      for (auto& v : values) {
+         baseline_decimal_to_binary(r, v);
+         sink += r[0];
+      }
+   });
+   bench("decimal_to_binary<16>", values.size(), [&] {
+      std::array<uint8_t, 16> r;
+      for (auto& v : values) {
+         abieos::decimal_to_binary(r, v);
+         sink += r[0];
+      }
+   });
+
+}
+
+// json_to_bin on an action whose payload is mostly integers
+void bench_integer_action() {
+   eosio::abi abi{ R"({
+      "version": "eosio::abi/1.1",
+      "structs": [{
+         "name": "row", "base": "",
+         "fields": [
+            {"name": "id", "type": "uint64"}, {"name": "delta", "type": "int64"},
+            {"name": "count", "type": "uint32"}, {"name": "total", "type": "int128"},
+            {"name": "quantity", "type": "asset"}, {"name": "values", "type": "int32[]"}
+         ]
+      }, {
+         "name": "batch", "base": "",
+         "fields": [{"name": "rows", "type": "row[]"}]
+      }]
+   })" };
+   std::mt19937_64 rng(2);
+   std::string     json = R"({"rows":[)";
+   for (int i = 0; i < 100; ++i) {
+      if (i)
+         json += ',';
+      json += R"({"id":)" + std::to_string(rng()) + R"(,"delta":)" + std::to_string(int64_t(rng())) +
+              R"(,"count":)" + std::to_string(uint32_t(rng())) + R"(,"total":")" + std::to_string(rng() >> 8) +
+              std::to_string(rng() >> 4) + R"(","quantity":")" + std::to_string(rng() >> 20) +
+              R"(.0000 EOS","values":[)";
+      for (int j = 0; j < 8; ++j) json += (j ? "," : "") + std::to_string(int32_t(rng()));
+      json += "]}";
+   }
+   json += "]}";
+   auto type = abi.get_type("batch");
+   bench("json_to_bin integer-heavy action (per row)", 100, [&] { sink += type->json_to_bin(json).size(); });
+}
+
+// Many small documents, one call each versus one batch
+void bench_batch() {
+   eosio::abi abi{ R"({
+      "version": "eosio::abi/1.1",
+      "structs": [{
+         "name": "transfer", "base": "",
+         "fields": [
+            {"name": "from", "type": "name"}, {"name": "to", "type": "name"},
+            {"name": "quantity", "type": "asset"}, {"name": "memo", "type": "string"}
+         ]
+      }]
+   })" };
+   std::vector<std::string>      docs;
+   std::vector<std::string_view> views;
+   std::string                   ndjson;
+   for (int i = 0; i < 1000; ++i) {
+      docs.push_back(R"({"from":"alice","to":"bob","quantity":")" + std::to_string(i) +
+                     R"(.0000 EOS","memo":"payment )" + std::to_string(i) + R"("})");
+      ndjson += docs.back() + '\n';
+   }
+   for (auto& d : docs) views.push_back(d);
+   auto type = abi.get_type("transfer");
+   bench("json_to_bin per document", docs.size(), [&] {
+      for (auto& d : docs) sink += type->json_to_bin(d).size();
+   });
+   eosio::json_to_bin_batch_result result;
+   bench("json_to_bin_batch", docs.size(), [&] {
+      type->json_to_bin_batch(result, views.data(), views.size());
+      sink += result.bin.size();
+   });
+   bench("json_to_bin_ndjson", docs.size(), [&] {
+      type->json_to_bin_ndjson(result, ndjson);
+      sink += result.bin.size();
+   });
+}
+
+// Reorderable conversion of in-order and reordered input, against the jvalue path it used to take
+void bench_reorderable() {
+   eosio::abi abi{ R"({
+      "version": "eosio::abi/1.1",
+      "structs": [{
+         "name": "transfer", "base": "",
+         "fields": [
+            {"name": "from", "type": "name"}, {"name": "to", "type": "name"},
+            {"name": "quantity", "type": "asset"}, {"name": "memo", "type": "string"}
+         ]
+      }]
+   })" };
+   auto        type      = abi.get_type("transfer");
+   std::string ordered   = R"({"from":"alice","to":"bob","quantity":"1.0000 EOS","memo":"payment"})";
+   std::string reordered = R"({"to":"bob","from":"alice","memo":"payment","quantity":"1.0000 EOS"})";
+   for (auto& [name, json] : { std::pair{ "ordered", ordered }, std::pair{ "reordered", reordered } }) {
+      bench((std::string("json_to_bin_reorderable jvalue, ") + name).c_str(), 1, [&] {
+         abieos::jvalue value;
+         abieos::json_to_jvalue(value, json, [] {});
+         std::vector<char> bin;
+         abieos::json_to_bin(bin, type, value, [] {});
+         sink += bin.size();
+      });
+      bench((std::string("json_to_bin_reorderable, ") + name).c_str(), 1,
+            [&] { sink += type->json_to_bin_reorderable(json).size(); });
+   }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// assets
+///////////////////////////////////////////////////////////////////////////////
+
+// Formatter previously used by to_json(asset), followed by the generic string escaper
+std::string baseline_asset_to_string(int64_t amount, uint64_t symbol) {
+   std::string result;
+   uint64_t    uamount   = amount < 0 ? -amount : amount;
+   uint8_t     precision = symbol;
+   if (precision) {
+      while (precision--) {
+         result += '0' + uamount % 10;
+         uamount /= 10;
+      }
+      result += '.';
+   }
+   do {
+      result += '0' + uamount % 10;
+      uamount /= 10;
+   } while (uamount);
+   if (amount < 0)
+      result += '-';
+   std::reverse(result.begin(), result.end());
+   return result + ' ' + eosio::symbol_code_to_string(symbol >> 8);
+}
+
+void bench_assets() {
+   std::vector<std::string>  strs;
+   std::vector<eosio::asset> assets;
+   std::string               json = "[";
+   for (auto& v : random_integers(1024, 14, true)) {
+      strs.push_back(v + ".0000 EOS");
+      json += (assets.empty() ? "\"" : ",\"") + strs.back() + '"';
+      int64_t  amount;
+      uint64_t sym;
+      if (!eosio::string_to_asset(amount, sym, strs.back().data(), strs.back().data() + strs.back().size()))
+         abort();
+      assets.push_back(eosio::asset{ amount, eosio::symbol{ sym } });
+   }
+   json += "]";
+   std::vector<char>    buf;
+   eosio::vector_stream stream{ buf };
+   bench("asset to_json baseline", assets.size(), [&] {
+      buf.clear();
+      for (auto& a : assets) eosio::to_json(baseline_asset_to_string(a.amount, a.symbol.value), stream);
+      sink += buf.size();
+   });
+   bench("asset to_json", assets.size(), [&] {
+      buf.clear();
+      for (auto& a : assets) eosio::to_json(a, stream);
+      sink += buf.size();
+   });
+   bench("string_to_asset", strs.size(), [&] {
+      int64_t  amount;
+      uint64_t sym;
+      for (auto& a : strs) {
+         if (eosio::string_to_asset(amount, sym, a.data(), a.data() + a.size()))
+            sink += amount;
+      }
+   });
+   std::vector<eosio::asset> parsed;
+   std::string               copy;
+   bench("asset from_json", strs.size(), [&] {
+      copy = json;
+      eosio::json_token_stream stream{ copy.data() };
+      eosio::from_json(parsed, stream);
+      sink += parsed.size();
+   });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// timestamps
+///////////////////////////////////////////////////////////////////////////////
+
+// Formatter previously used by to_json(time_point), followed by the generic string escaper
+std::string baseline_microseconds_to_str(uint64_t microseconds) {
+   std::string result;
+   auto        append_uint = [&result](uint32_t value, int digits) {
+      char  s[20];
+      char* ch = s;
+      while (digits--) {
+         *ch++ = '0' + (value % 10);
+         value /= 10;
+      };
+      std::reverse(s, ch);
+      result.insert(result.end(), s, ch);
+   };
+   using days = std::chrono::duration<int, std::ratio<86400>>;
+   std::chrono::microseconds us{ microseconds };
+   eosio::sys_days           sd(std::chrono::floor<days>(us));
+   auto                      ymd = eosio::year_month_day{ sd };
+   uint32_t                  ms  = (std::chrono::floor<std::chrono::milliseconds>(us) - sd.time_since_epoch()).count();
+   append_uint((int)ymd.year(), 4);
+   result.push_back('-');
+   append_uint((unsigned)ymd.month(), 2);
+   result.push_back('-');
+   append_uint((unsigned)ymd.day(), 2);
+   result.push_back('T');
+   append_uint(ms / 3600000 % 60, 2);
+   result.push_back(':');
+   append_uint(ms / 60000 % 60, 2);
+   result.push_back(':');
+   append_uint(ms / 1000 % 60, 2);
+   result.push_back('.');
+   append_uint(ms % 1000, 3);
+   return result;
+}
+
+void bench_timestamps() {
+   // Consecutive block times, half a second apart
+   std::vector<eosio::time_point> times;
+   std::vector<std::string>       strs;
+   for (int i = 0; i < 1024; ++i) {
+      times.push_back(eosio::time_point{ eosio::microseconds{ 1'600'000'000'000'000 + i * 500'000ll } });
+      strs.push_back(eosio::microseconds_to_str(times.back().elapsed.count()));
+   }
+   std::vector<char>    buf;
+   eosio::vector_stream stream{ buf };
+   bench("time_point to_json baseline", times.size(), [&] {
+      buf.clear();
+      for (auto& t : times) eosio::to_json(baseline_microseconds_to_str(t.elapsed.count()), stream);
+      sink += buf.size();
+   });
+   bench("time_point to_json", times.size(), [&] {
+      buf.clear();
+      for (auto& t : times) eosio::to_json(t, stream);
+      sink += buf.size();
+   });
+   bench("string_to_utc_microseconds", strs.size(), [&] {
+      uint64_t us;
+      for (auto& s : strs)
+         if (eosio::string_to_utc_microseconds(us, s.data(), s.data() + s.size()))
+            sink += us;
+   });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// base58
+///////////////////////////////////////////////////////////////////////////////
+
+// Byte-at-a-time codec previously used for keys and signatures
+std::string baseline_binary_to_base58(std::string_view bin) {
+   std::string result;
+   for (auto byte : bin) {
+      int carry = static_cast<uint8_t>(byte);
+      for (auto& result_digit : result) {
+         int x        = (eosio::base58_map[result_digit] << 8) + carry;
+         result_digit = eosio::base58_chars[x % 58];
+         carry        = x / 58;
+      }
+      while (carry) {
+         result.push_back(eosio::base58_chars[carry % 58]);
+         carry = carry / 58;
+      }
+   }
+   for (auto byte : bin)
+      if (byte)
+         break;
+      else
+         result.push_back('1');
+   std::reverse(result.begin(), result.end());
+   return result;
+}
+
+void baseline_base58_to_binary(std::vector<char>& result, std::string_view s) {
+   for (auto& src_digit : s) {
+      int carry = eosio::base58_map[static_cast<uint8_t>(src_digit)];
+      for (auto& result_byte : result) {
+         int x       = static_cast<uint8_t>(result_byte) * 58 + carry;
+         result_byte = x;
+         carry       = x >> 8;
+      }
+      if (carry)
+         result.push_back(static_cast<uint8_t>(carry));
+   }
+   for (auto& src_digit : s)
+      if (src_digit == '1')
+         result.push_back(0);
+      else
+         break;
+   std::reverse(result.begin(), result.end());
+}
+
+void bench_base58() {
+   // A k1 signature with its checksum
+   std::mt19937_64          rng(4);
+   std::vector<std::string> bins, strs;
+   for (int i = 0; i < 256; ++i) {
+      std::string bin;
+      for (int j = 0; j < 69; ++j) bin += char(rng());
+      bins.push_back(bin);
+      strs.push_back(eosio::binary_to_base58(bin));
+   }
+   bench("binary_to_base58 baseline (69 bytes)", bins.size(), [&] {
+      for (auto& b : bins) sink += baseline_binary_to_base58(b).size();
+   });
+   bench("binary_to_base58 (69 bytes)", bins.size(), [&] {
+      for (auto& b : bins) sink += eosio::binary_to_base58(b).size();
+   });
+   std::vector<char> out;
+   bench("base58_to_binary baseline (69 bytes)", strs.size(), [&] {
+      for (auto& s : strs) {
+         out.clear();
+         baseline_base58_to_binary(out, s);
+         sink += out.size();
+      }
+   });
+   bench("base58_to_binary (69 bytes)", strs.size(), [&] {
+      for (auto& s : strs) {
+         out.clear();
+         if (eosio::base58_to_binary(out, s))
+            sink += out.size();
+      }
+   });
+
+   std::vector<eosio::signature> sigs;
+   for (int i = 0; i < 256; ++i) {
+      eosio::ecc_signature sig;
+      for (auto& b : sig) b = char(rng());
+      sigs.push_back(eosio::signature{ std::in_place_index<0>, sig });
+   }
+   std::vector<char>    buf;
+   eosio::vector_stream stream{ buf };
+   bench("signature to_json", sigs.size(), [&] {
+      buf.clear();
+      for (auto& sig : sigs) eosio::to_json(sig, stream);
+      sink += buf.size();
+   });
+   std::vector<std::string> sig_strs;
+   for (auto& sig : sigs) sig_strs.push_back(eosio::signature_to_string(sig));
+   bench("signature_from_string", sig_strs.size(), [&] {
+      for (auto& s : sig_strs) sink += eosio::signature_from_string(s).index();
+   });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// names
+///////////////////////////////////////////////////////////////////////////////
+
+void bench_names() {
+   // A few hot names repeated, as in token transfers, plus random ones
+   std::vector<uint64_t> names;
+   std::mt19937_64       rng(3);
+   const char*           hot[] = { "eosio.token", "transfer", "active", "owner", "eosio", "alice", "bob" };
+   for (int i = 0; i < 1024; ++i)
+      names.push_back(i % 4 ? eosio::string_to_name(hot[rng() % 7]) : rng());
+   std::vector<char>    buf;
+   eosio::vector_stream stream{ buf };
+   bench("name to_json baseline", names.size(), [&] {
+      buf.clear();
+      for (auto n : names) eosio::to_json(eosio::name_to_string(n), stream);
+      sink += buf.size();
+   });
+   bench("name to_json", names.size(), [&] {
+      buf.clear();
+      for (auto n : names) eosio::to_json(eosio::name{ n }, stream);
+      sink += buf.size();
+   });
+   eosio::name_json_cache cache;
+   bench("name to_json cached", names.size(), [&] {
+      buf.clear();
+      for (auto n : names) cache.write(n, stream);
+      sink += buf.size();
+   });
+   std::vector<char>             chars(13 * names.size());
+   std::vector<std::string_view> strs(names.size());
+   bench("names_to_strings", names.size(), [&] {
+      eosio::names_to_strings(names.data(), names.size(), chars.data(), strs.data());
+      sink += strs[0].size();
+   });
+   std::vector<uint64_t> decoded(names.size());
+   bench("string_to_name_strict", names.size(), [&] {
+      for (size_t i = 0; i < strs.size(); ++i) decoded[i] = eosio::string_to_name_strict(strs[i]);
+      sink += decoded[0];
+   });
+   bench("strings_to_names", names.size(), [&] {
+      sink += eosio::strings_to_names(strs.data(), strs.size(), decoded.data());
+   });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ripemd160 checksums
+///////////////////////////////////////////////////////////////////////////////
+
+void bench_ripemd160() {
+   // Signature checksum messages: 65 key bytes plus the "K1" suffix
+   std::mt19937_64                   rng(5);
+   std::vector<std::string>          msgs(256);
+   std::vector<const unsigned char*> data;
+   std::vector<size_t>               sizes;
+   for (auto& m : msgs) {
+      for (int j = 0; j < 67; ++j) m += char(rng());
+      data.push_back(reinterpret_cast<const unsigned char*>(m.data()));
+      sizes.push_back(m.size());
+   }
+   std::vector<std::array<unsigned char, 20>> digests(msgs.size());
+   auto out = reinterpret_cast<unsigned char(*)[20]>(digests.data());
+   bench("ripemd160 scalar (67 bytes)", msgs.size(), [&] {
+      for (size_t i = 0; i < msgs.size(); ++i) {
+         abieos_ripemd160::ripemd160_state state;
+         abieos_ripemd160::ripemd160_init(&state);
+         abieos_ripemd160::ripemd160_update(&state, data[i], sizes[i]);
+         abieos_ripemd160::ripemd160_digest(&state, out[i]);
+      }
+      sink += out[0][0];
+   });
+   bench("ripemd160 4 lanes (67 bytes)", msgs.size(), [&] {
+      for (size_t i = 0; i < msgs.size(); i += 4)
+         abieos_ripemd160::ripemd160_multi<4>::hash(&data[i], &sizes[i], 4, out + i);
+      sink += out[0][0];
+   });
+   bench("ripemd160 8 lanes (67 bytes)", msgs.size(), [&] {
+      for (size_t i = 0; i < msgs.size(); i += 8)
+         abieos_ripemd160::ripemd160_multi<8>::hash(&data[i], &sizes[i], 8, out + i);
+      sink += out[0][0];
+   });
+
+   std::vector<eosio::signature> sigs;
+   for (int i = 0; i < 256; ++i) {
+      eosio::ecc_signature sig;
+      for (auto& b : sig) b = char(rng());
+      sigs.push_back(eosio::signature{ std::in_place_index<0>, sig });
+   }
+   std::vector<std::string> strs(sigs.size());
+   bench("signature_to_string", sigs.size(), [&] {
+      for (size_t i = 0; i < sigs.size(); ++i) strs[i] = eosio::signature_to_string(sigs[i]);
+      sink += strs[0].size();
+   });
+   bench("signatures_to_strings", sigs.size(), [&] {
+      eosio::signatures_to_strings(sigs.data(), sigs.size(), strs.data());
+      sink += strs[0].size();
+   });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// strings
+///////////////////////////////////////////////////////////////////////////////
+
+// Escaper previously used by to_json(std::string_view), validating one code point at a time
+template <typename S>
+void baseline_string_to_json(std::string_view sv, S& stream) {
+   stream.write('"');
+   auto begin = sv.begin();
+   auto end   = sv.end();
+   while (begin != end) {
+      auto pos = begin;
+      while (pos != end && *pos != '"' && *pos != '\\' && (unsigned char)(*pos) >= 32 && *pos != 127) ++pos;
+      while (begin != pos) {
+         eosio::stream_adaptor s2(begin, static_cast<std::size_t>(pos - begin));
+         if (rapidjson::UTF8<>::Validate(s2, s2)) {
+            stream.write(begin, s2.idx);
+            begin += s2.idx;
+         } else {
+            ++begin;
+            stream.write('?');
+         }
+      }
+      if (begin != end) {
+         if (*begin == '"') {
+            stream.write("\\\"", 2);
+         } else if (*begin == '\\') {
+            stream.write("\\\\", 2);
+         } else if (*begin == '\b') {
+            stream.write("\\b", 2);
+         } else if (*begin == '\f') {
+            stream.write("\\f", 2);
+         } else if (*begin == '\n') {
+            stream.write("\\n", 2);
+         } else if (*begin == '\r') {
+            stream.write("\\r", 2);
+         } else if (*begin == '\t') {
+            stream.write("\\t", 2);
+         } else {
+            stream.write("\\u00", 4);
+            stream.write(eosio::hex_digits[(unsigned char)(*begin) >> 4]);
+            stream.write(eosio::hex_digits[(unsigned char)(*begin) & 15]);
+         }
+         ++begin;
+      }
+   }
+   stream.write('"');
+}
+
+void bench_strings() {
+   std::mt19937_64 rng(6);
+   std::string     memo = "Payment for invoice 1234, thanks! See you next week.";
+   std::string     console;
+   while (console.size() < 4096)
+      console += "apply: processed row " + std::to_string(rng() % 100000) + " with \"status\": ok\n";
+   std::string utf8;
+   while (utf8.size() < 4096) utf8 += "Zahlung f\xc3\xbcr Rechnung \xe2\x82\xac 12 \xf0\x9f\x98\x80 ";
+   std::vector<char>    buf;
+   eosio::vector_stream stream{ buf };
+   for (auto [label, str] : { std::pair{ "memo", &memo }, std::pair{ "console", &console }, std::pair{ "utf8", &utf8 } }) {
+      auto size = std::to_string(str->size());
+      bench(("string to_json baseline (" + std::string(label) + ", " + size + " bytes)").c_str(), 1, [&] {
+         buf.clear();
+         baseline_string_to_json(*str, stream);
+         sink += buf.size();
+      });
+      bench(("string to_json (" + std::string(label) + ", " + size + " bytes)").c_str(), 1, [&] {
+         buf.clear();
+         eosio::to_json(std::string_view{ *str }, stream);
+         sink += buf.size();
+      });
+   }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// varuints
+///////////////////////////////////////////////////////////////////////////////
+
+// Byte-at-a-time decoders previously used by varuint32_from_bin and varuint64_from_bin
+void baseline_varuint32_from_bin(uint32_t& dest, eosio::input_stream& stream) {
+   dest          = 0;
+   int     shift = 0;
+   uint8_t b     = 0;
+   do {
+      eosio::check(shift < 35, eosio::convert_stream_error(eosio::stream_error::invalid_varuint_encoding));
+      eosio::from_bin(b, stream);
+      dest |= uint32_t(b & 0x7f) << shift;
+      shift += 7;
+   } while (b & 0x80);
+}
+
+void baseline_varuint64_from_bin(uint64_t& dest, eosio::input_stream& stream) {
+   dest          = 0;
+   int     shift = 0;
+   uint8_t b     = 0;
+   do {
+      eosio::check(shift < 70, eosio::convert_stream_error(eosio::stream_error::invalid_varuint_encoding));
+      eosio::from_bin(b, stream);
+      dest |= uint64_t(b & 0x7f) << shift;
+      shift += 7;
+   } while (b & 0x80);
+}
+
+void bench_varuint_mix(const char* mix, std::function<uint64_t(std::mt19937_64&)> gen) {
+   std::mt19937_64      rng(7);
+   std::vector<char>    bin32, bin64;
+   eosio::vector_stream stream32{ bin32 };
+   size_t               count = 4096;
+   for (size_t i = 0; i < count; ++i) {
+      uint64_t v = gen(rng);
+      eosio::varuint32_to_bin(uint32_t(v), stream32);
+      for (; v >= 0x80; v >>= 7) bin64.push_back(char(v | 0x80));
+      bin64.push_back(char(v));
+   }
+   auto run = [&](const char* name, std::vector<char>& bin, auto decode) {
+      bench((std::string(name) + " (" + mix + ")").c_str(), count, [&] {
+         eosio::input_stream stream{ bin };
+         uint64_t            sum = 0;
+         while (stream.remaining()) sum += decode(stream);
+         sink += sum;
+      });
+   };
+   run("varuint32_from_bin baseline", bin32, [](auto& stream) {
+      uint32_t v;
+      baseline_varuint32_from_bin(v, stream);
+      return v;
+   });
+   run("varuint32_from_bin", bin32, [](auto& stream) {
+      uint32_t v;
+      eosio::varuint32_from_bin(v, stream);
+      return v;
+   });
+   run("varuint64_from_bin baseline", bin64, [](auto& stream) {
+      uint64_t v;
+      baseline_varuint64_from_bin(v, stream);
+      return v;
+   });
+   run("varuint64_from_bin", bin64, [](auto& stream) {
+      uint64_t v;
+      eosio::varuint64_from_bin(v, stream);
+      return v;
+   });
+}
+
+void bench_varuints() {
+   bench_varuint_mix("1 byte", [](auto& rng) { return rng() % 128; });
+   bench_varuint_mix("2-3 bytes", [](auto& rng) { return 128 + rng() % 100000; });
+   bench_varuint_mix("1-5 bytes", [](auto& rng) { return uint32_t(rng()) >> (rng() % 32); });
+   // Mostly small array and string lengths, with some larger sizes and full-width values
+   bench_varuint_mix("mixed", [](auto& rng) {
+      auto kind = rng() % 16;
+      return kind < 10 ? rng() % 128 : kind < 14 ? rng() % 100000 : rng() >> (rng() % 64);
+   });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fixed-size structs
+///////////////////////////////////////////////////////////////////////////////
+
+// Streams which take the per-member, per-read checked paths the fixed-size fast paths replaced
+struct baseline_input_stream : eosio::input_stream {
+   using eosio::input_stream::input_stream;
+};
+
+struct baseline_vector_stream : eosio::vector_stream {
+   using eosio::vector_stream::vector_stream;
+};
+
+template <typename T>
+void bench_fixed_struct(const char* name) {
+   std::mt19937_64   rng(8);
+   std::vector<char> bin;
+   size_t            count = 1024;
+   for (size_t i = 0; i < count * eosio::fixed_bin_size_v<T>; ++i) bin.push_back(char(rng()));
+   std::vector<T> values(count);
+   bench((std::string(name) + " from_bin baseline").c_str(), count, [&] {
+      baseline_input_stream stream{ bin };
+      for (auto& v : values) eosio::from_bin(v, stream);
+      sink += stream.pos - bin.data();
+   });
+   bench((std::string(name) + " from_bin").c_str(), count, [&] {
+      eosio::input_stream stream{ bin };
+      for (auto& v : values) eosio::from_bin(v, stream);
+      sink += stream.pos - bin.data();
+   });
+   std::vector<char> out;
+   bench((std::string(name) + " to_bin baseline").c_str(), count, [&] {
+      out.clear();
+      baseline_vector_stream stream{ out };
+      for (auto& v : values) eosio::to_bin(v, stream);
+      sink += out.size();
+   });
+   bench((std::string(name) + " to_bin").c_str(), count, [&] {
+      out.clear();
+      eosio::vector_stream stream{ out };
+      for (auto& v : values) eosio::to_bin(v, stream);
+      sink += out.size();
+   });
+}
+
+void bench_fixed_structs() {
+   bench_fixed_struct<eosio::ship_protocol::permission_level>("permission_level");
+   bench_fixed_struct<eosio::ship_protocol::block_position>("block_position");
+   bench_fixed_struct<eosio::extended_asset>("extended_asset");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// output streams
+///////////////////////////////////////////////////////////////////////////////
+
+void bench_output_streams() {
+   std::mt19937_64                                     rng(9);
+   std::vector<eosio::ship_protocol::permission_level> levels(100000);
+   for (auto& l : levels) l = { eosio::name{ rng() }, eosio::name{ rng() } };
+   // Baseline: a fresh vector grown by doubling, as bin_to_json did before segmented_stream
+   bench("to_json 100k levels vector_stream baseline", levels.size(), [&] {
+      std::vector<char>    out;
+      eosio::vector_stream stream{ out };
+      eosio::to_json(levels, stream);
+      std::string dest(out.begin(), out.end());
+      sink += dest.size();
+   });
+   bench("to_json 100k levels segmented_stream", levels.size(), [&] {
+      eosio::segmented_stream stream;
+      eosio::to_json(levels, stream);
+      std::string dest(stream.size(), 0);
+      stream.copy_to(dest.data());
+      sink += dest.size();
+   });
+   bench("to_bin 100k levels vector_stream baseline", levels.size(), [&] {
+      std::vector<char>    out;
+      eosio::vector_stream stream{ out };
+      eosio::to_bin(levels, stream);
+      sink += out.size();
+   });
+   bench("to_bin 100k levels segmented_stream", levels.size(), [&] {
+      eosio::segmented_stream stream;
+      eosio::to_bin(levels, stream);
+      sink += stream.size();
+   });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// convert_to_json / convert_to_bin
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+void bench_convert(const char* name, const T& value) {
+   using eosio::convert_mode;
+   for (auto [mode, mode_name] : { std::pair{ convert_mode::two_pass, "two_pass" },
+                                   std::pair{ convert_mode::single_pass, "single_pass" } }) {
+      bench((std::string("convert_to_json ") + name + " " + mode_name).c_str(), 1,
+            [&, mode = mode] { sink += eosio::convert_to_json(value, mode).size(); });
+   }
+   for (auto [mode, mode_name] : { std::pair{ convert_mode::two_pass, "two_pass" },
+                                   std::pair{ convert_mode::single_pass, "single_pass" } }) {
+      bench((std::string("convert_to_bin ") + name + " " + mode_name).c_str(), 1,
+            [&, mode = mode] { sink += eosio::convert_to_bin(value, mode).size(); });
+   }
+}
+
+void bench_converts() {
+   std::mt19937_64                                     rng(10);
+   std::vector<eosio::ship_protocol::permission_level> levels(10000);
+   for (auto& l : levels) l = { eosio::name{ rng() }, eosio::name{ rng() } };
+   std::vector<std::string> strings(1000);
+   for (auto& s : strings) s = std::string(rng() % 64, char('a' + rng() % 26));
+   std::vector<char>            data(64, 'x');
+   eosio::ship_protocol::action action{ eosio::name{ "eosio.token" }, eosio::name{ "transfer" },
+                                        { levels.begin(), levels.begin() + 2 }, eosio::input_stream{ data } };
+   bench_convert("name", eosio::name{ "eosio.token" });
+   bench_convert("action", action);
+   bench_convert("10k levels", levels);
+   bench_convert("1k strings", strings);
+}
+
+void bench_fd_streams() {
+   std::mt19937_64                                     rng(11);
+   std::vector<eosio::ship_protocol::permission_level> levels(100000);
+   for (auto& l : levels) l = { eosio::name{ rng() }, eosio::name{ rng() } };
+   int fd = open("/dev/null", O_WRONLY);
+   // Baseline: build the whole document in memory, then write it
+   bench("to_json 100k levels to fd baseline", levels.size(), [&] {
+      auto json = eosio::convert_to_json(levels);
+      sink += write(fd, json.data(), json.size());
+   });
+   bench("to_json 100k levels fd_stream", levels.size(), [&] {
+      eosio::fd_stream out{ fd };
+      eosio::to_json(levels, out);
+      out.flush();
+      sink += out.written;
+   });
+   close(fd);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// reflected struct keys
+///////////////////////////////////////////////////////////////////////////////
+
+// The generic reflected to_json before keys were built at compile time. Members still use the current
+// to_json, so only the top level's keys are measured.
+template <typename T, typename S>
+void baseline_struct_to_json(const T& t, S& stream) {
+   bool first = true;
+   stream.write('{');
+   eosio::for_each_field<T>([&](const char* name, auto&& member) {
+      if (first) {
+         eosio::increase_indent(stream);
+         first = false;
+      } else {
+         stream.write(',');
+      }
+      eosio::write_newline(stream);
+      eosio::to_json(name, stream);
+      eosio::write_colon(stream);
+      eosio::to_json(member(&t), stream);
+   });
+   if (!first) {
+      eosio::decrease_indent(stream);
+      eosio::write_newline(stream);
+   }
+   stream.write('}');
+}
+
+template <typename T>
+void bench_struct_keys(const char* name, const std::vector<T>& values) {
+   std::vector<char> out;
+   bench((std::string(name) + " to_json baseline").c_str(), values.size(), [&] {
+      out.clear();
+      eosio::vector_stream stream{ out };
+      for (auto& v : values) baseline_struct_to_json(v, stream);
+      sink += out.size();
+   });
+   bench((std::string(name) + " to_json").c_str(), values.size(), [&] {
+      out.clear();
+      eosio::vector_stream stream{ out };
+      for (auto& v : values) eosio::to_json(v, stream);
+      sink += out.size();
+   });
+}
+
+void bench_struct_keys() {
+   std::mt19937_64                                          rng(12);
+   std::vector<eosio::ship_protocol::get_status_result_v0> statuses(1000);
+   for (auto& s : statuses) {
+      s.head.block_num        = rng();
+      s.trace_begin_block     = rng() % 1000;
+      s.chain_state_end_block = rng();
+   }
+   std::vector<eosio::ship_protocol::action_trace_v1> traces(1000);
+   for (auto& t : traces) {
+      t.receiver = eosio::name{ rng() };
+      t.act.name = eosio::name{ rng() };
+      t.elapsed  = rng() % 1000;
+   }
+   bench_struct_keys("get_status_result_v0", statuses);
+   bench_struct_keys("action_trace_v1", traces);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// variants
+///////////////////////////////////////////////////////////////////////////////
+
+// Variant dispatch before the jump tables: a compare per alternative to decode, two visits to format
+template <uint32_t I, typename... Ts, typename S>
+void baseline_variant_from_bin(std::variant<Ts...>& v, uint32_t i, S& stream) {
+   if constexpr (I < sizeof...(Ts)) {
+      if (i == I)
+         eosio::from_bin(v.template emplace<I>(), stream);
+      else
+         baseline_variant_from_bin<I + 1>(v, i, stream);
+   } else {
+      eosio::check(false, eosio::convert_stream_error(eosio::stream_error::bad_variant_index));
+   }
+}
+
+template <typename... Ts, typename S>
+void baseline_variant_to_json(const std::variant<Ts...>& obj, S& stream) {
+   stream.write('[');
+   std::visit([&](const auto& t) { eosio::to_json(eosio::get_type_name((std::decay_t<decltype(t)>*)nullptr), stream); }, obj);
+   stream.write(',');
+   std::visit([&](auto& x) { return eosio::to_json(x, stream); }, obj);
+   stream.write(']');
+}
+
+void bench_variants() {
+   using variant = std::variant<uint8_t, int8_t, uint16_t, int16_t, uint32_t, int32_t, uint64_t, int64_t,
+                                eosio::name, std::string>;
+   std::mt19937_64      rng(13);
+   std::vector<variant> values;
+   for (int i = 0; i < 1000; ++i) {
+      auto tag = rng() % std::variant_size_v<variant>;
+      eosio::dispatch_index<std::variant_size_v<variant>>(tag, [&](auto i) {
+         values.push_back(variant{ std::in_place_index<decltype(i)::value> });
+      });
+   }
+   auto              bin = eosio::convert_to_bin(values);
+   std::vector<char> out;
+   bench("variant from_bin baseline", values.size(), [&] {
+      eosio::input_stream stream{ bin };
+      uint32_t            size;
+      eosio::varuint32_from_bin(size, stream);
+      for (auto& v : values) {
+         uint32_t tag;
+         eosio::varuint32_from_bin(tag, stream);
+         baseline_variant_from_bin<0>(v, tag, stream);
+      }
+      sink += stream.pos - bin.data();
+   });
+   bench("variant from_bin", values.size(), [&] {
+      eosio::input_stream stream{ bin };
+      uint32_t            size;
+      eosio::varuint32_from_bin(size, stream);
+      for (auto& v : values) eosio::from_bin(v, stream);
+      sink += stream.pos - bin.data();
+   });
+   bench("variant to_json baseline", values.size(), [&] {
+      out.clear();
+      eosio::vector_stream stream{ out };
+      for (auto& v : values) baseline_variant_to_json(v, stream);
+      sink += out.size();
+   });
+   bench("variant to_json", values.size(), [&] {
+      out.clear();
+      eosio::vector_stream stream{ out };
+      for (auto& v : values) eosio::to_json(v, stream);
+      sink += out.size();
+   });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// decode arena
+///////////////////////////////////////////////////////////////////////////////
+
+// Traces with 4 action_trace_v1s each, shared by the ship decoding benchmarks
+std::vector<eosio::ship_protocol::transaction_trace> make_bench_traces(std::mt19937_64& rng, size_t count,
+                                                                       size_t max_console, bool with_disk_deltas) {
+   namespace ship = eosio::ship_protocol;
+   std::vector<ship::transaction_trace> traces(count);
+   for (auto& t : traces) {
+      for (int i = 0; i < 4; ++i) {
+         ship::action_trace_v1 action;
+         action.receipt            = ship::action_receipt_v0{ eosio::name{ rng() } };
+         action.receiver           = eosio::name{ rng() };
+         action.act.authorization  = { { eosio::name{ rng() }, eosio::name{ "active" } } };
+         action.console            = std::string(rng() % max_console, 'c');
+         action.account_ram_deltas = { { eosio::name{ rng() }, 1 } };
+         if (with_disk_deltas)
+            action.account_disk_deltas = { { eosio::name{ rng() }, 1 }, { eosio::name{ rng() }, 2 } };
+         std::get<0>(t).action_traces.push_back(action);
+      }
+   }
+   return traces;
+}
+
+void bench_decode_arena() {
+   namespace ship = eosio::ship_protocol;
+   std::mt19937_64 rng(14);
+   auto            traces = make_bench_traces(rng, 200, 64, false);
+   auto bin = eosio::convert_to_bin(traces);
+   // Baseline: every container on the global heap
+   bench("decode 200 traces heap baseline", traces.size(), [&] {
+      eosio::input_stream                  stream{ bin };
+      std::vector<ship::transaction_trace> decoded;
+      eosio::from_bin(decoded, stream);
+      sink += decoded.size();
+   });
+   eosio::decode_arena arena;
+   bench("decode 200 traces decode_arena", traces.size(), [&] {
+      eosio::input_stream stream{ bin };
+      {
+         auto decoded = eosio::from_bin_in_arena<eosio::arena_vector<ship::arena::transaction_trace>>(arena, stream);
+         sink += decoded.size();
+      }
+      arena.reset();
+   });
+   bench("decode 200 traces view", traces.size(), [&] {
+      eosio::input_stream                                stream{ bin };
+      eosio::sequence_view<ship::view::transaction_trace> decoded;
+      eosio::from_bin(decoded, stream);
+      sink += decoded.size();
+   });
+   bench("decode 200 traces view, read consoles", traces.size(), [&] {
+      eosio::input_stream                                stream{ bin };
+      eosio::sequence_view<ship::view::transaction_trace> decoded;
+      eosio::from_bin(decoded, stream);
+      for (auto& t : decoded)
+         for (auto& a : std::get<0>(t).action_traces) sink += std::get<1>(a).console.size();
+   });
+}
+
+void bench_skip_fields() {
+   namespace ship = eosio::ship_protocol;
+   std::mt19937_64 rng(15);
+   auto            traces = make_bench_traces(rng, 200, 256, true);
+   auto bin = eosio::convert_to_bin(traces);
+   // Baseline: every member decoded
+   bench("decode 200 traces all members baseline", traces.size(), [&] {
+      eosio::input_stream                  stream{ bin };
+      std::vector<ship::transaction_trace> decoded;
+      eosio::from_bin(decoded, stream);
+      sink += decoded.size();
+   });
+   bench("decode 200 traces skip_fields", traces.size(), [&] {
+      eosio::input_stream                  stream{ bin };
+      std::vector<ship::transaction_trace> decoded;
+      eosio::from_bin(decoded, stream,
+                      eosio::skip_fields<&ship::action_trace_v1::console, &ship::action_trace_v1::account_disk_deltas,
+                                         &ship::action_trace_v1::return_value>{});
+      sink += decoded.size();
+   });
+   bench("skip_bin 200 traces", traces.size(), [&] {
+      eosio::input_stream stream{ bin };
+      eosio::skip_bin<std::vector<ship::transaction_trace>>(stream);
+      sink += stream.remaining();
+   });
+}
+
+void bench_blocks_result_decoder() {
+   namespace ship = eosio::ship_protocol;
+   std::mt19937_64 rng(16);
+   auto            traces = make_bench_traces(rng, 50, 64, false);
+   std::vector<ship::table_delta> deltas(20, ship::table_delta_v0{ "contract_row", { { true, {} } } });
+   ship::signed_block_v1          block;
+   block.transactions.resize(50);
+   auto                           block_bin  = eosio::convert_to_bin(ship::signed_block_variant{ block });
+   auto                           traces_bin = eosio::convert_to_bin(traces);
+   auto                           deltas_bin = eosio::convert_to_bin(deltas);
+   std::vector<std::vector<char>> messages;
+   for (uint32_t i = 0; i < 100; ++i) {
+      ship::get_blocks_result_v2 result;
+      result.this_block = ship::block_position{ i };
+      result.block      = eosio::opaque<ship::signed_block_variant>{ block_bin };
+      result.traces     = eosio::opaque<std::vector<ship::transaction_trace>>{ traces_bin };
+      result.deltas     = eosio::opaque<std::vector<ship::table_delta>>{ deltas_bin };
+      messages.push_back(eosio::convert_to_bin(ship::result{ result }));
+   }
+   // Baseline: each message decoded in turn on the calling thread
+   bench("decode 100 blocks serial baseline", messages.size(), [&] {
+      for (auto& m : messages) {
+         eosio::input_stream stream{ m };
+         ship::result        result;
+         eosio::from_bin(result, stream);
+         auto&                                r = std::get<ship::get_blocks_result_v2>(result);
+         ship::signed_block_variant           b;
+         std::vector<ship::transaction_trace> t;
+         std::vector<ship::table_delta>       d;
+         eosio::unpack(r.block, b);
+         eosio::unpack(r.traces, t);
+         eosio::unpack(r.deltas, d);
+         sink += t.size() + d.size();
+      }
+   });
+   ship::blocks_result_decoder decoder;
+   bench("decode 100 blocks blocks_result_decoder", messages.size(), [&] {
+      size_t popped = 0;
+      for (auto& m : messages) {
+         while (decoder.full()) {
+            ship::decoded_blocks_result r;
+            decoder.pop(r);
+            sink += r.traces.size() + r.deltas.size();
+            ++popped;
+         }
+         decoder.push(m);
+      }
+      for (; popped < messages.size(); ++popped) {
+         ship::decoded_blocks_result r;
+         decoder.pop(r);
+         sink += r.traces.size() + r.deltas.size();
+      }
+   });
+}
+
+// Baseline: the chain of compares a consumer writes by hand
+int baseline_table_row_index(std::string_view name) {
+   static constexpr std::string_view names[] = { "account",
+                                                 "account_metadata",
+                                                 "code",
+                                                 "contract_table",
+                                                 "contract_row",
+                                                 "contract_index64",
+                                                 "contract_index128",
+                                                 "contract_index256",
+                                                 "contract_index_double",
+                                                 "contract_index_long_double",
+                                                 "key_value",
+                                                 "global_property",
+                                                 "generated_transaction",
+                                                 "protocol_state",
+                                                 "permission",
+                                                 "permission_link",
+                                                 "resource_limits",
+                                                 "resource_usage",
+                                                 "resource_limits_state",
+                                                 "resource_limits_config" };
+   for (int i = 0; i < int(std::size(names)); ++i)
+      if (name == names[i])
+         return i;
+   return -1;
+}
+
+void bench_table_deltas() {
+   namespace ship = eosio::ship_protocol;
+   std::vector<std::string> names;
+   for (size_t i = 0; i < std::variant_size_v<ship::table_row>; ++i)
+      eosio::dispatch_index<std::variant_size_v<ship::table_row>>(i, [&](auto n) {
+         names.push_back(ship::get_type_name((std::variant_alternative_t<decltype(n)::value, ship::table_row>*)nullptr));
+      });
+   bench("table name lookup compare chain baseline", names.size(), [&] {
+      for (auto& n : names) sink += baseline_table_row_index(n);
+   });
+   bench("table name lookup perfect hash", names.size(), [&] {
+      for (auto& n : names) sink += ship::table_row_index(n);
+   });
+
+   std::mt19937_64                rng(17);
+   std::vector<std::vector<char>> storage;
+   ship::table_delta_v1           rows{ "contract_row" };
+   std::vector<char>              value(16);
+   for (int i = 0; i < 20000; ++i) {
+      ship::contract_row_v0 row{ eosio::name{ rng() }, eosio::name{ rng() }, eosio::name{ "accounts" }, rng(),
+                                 eosio::name{ rng() }, eosio::input_stream{ value } };
+      storage.push_back(eosio::convert_to_bin(ship::contract_row{ row }));
+   }
+   for (auto& s : storage) rows.rows.push_back({ 2, eosio::input_stream{ s } });
+   std::vector<ship::table_delta> deltas{ rows };
+   bench("decode 20000 rows", rows.rows.size(), [&] { sink += ship::decode_table_deltas(deltas)[0].rows.size(); });
+   eosio::worker_pool pool;
+   bench("decode 20000 rows worker_pool", rows.rows.size(),
+         [&] { sink += ship::decode_table_deltas(deltas, &pool)[0].rows.size(); });
+}
+
+void bench_trace_cursor() {
+   namespace ship = eosio::ship_protocol;
+   std::mt19937_64 rng(18);
+   auto            traces = make_bench_traces(rng, 200, 64, false);
+   auto bin = eosio::convert_to_bin(traces);
+   // Baseline: decode the whole vector, then walk it
+   bench("walk 800 actions decoded vector baseline", 800, [&] {
+      eosio::input_stream                  stream{ bin };
+      std::vector<ship::transaction_trace> decoded;
+      eosio::from_bin(decoded, stream);
+      for (auto& t : decoded)
+         for (auto& a : std::get<0>(t).action_traces) sink += std::get<1>(a).receiver.value;
+   });
+   bench("walk 800 actions trace_cursor", 800, [&] {
+      ship::trace_cursor cursor{ eosio::input_stream{ bin } };
+      while (cursor.next()) sink += std::get<1>(cursor.action()).receiver.value;
+   });
+   bench("walk 800 actions trace_cursor<action_trace>", 800, [&] {
+      ship::basic_trace_cursor<ship::action_trace> cursor{ eosio::input_stream{ bin } };
+      while (cursor.next()) sink += std::get<1>(cursor.action()).receiver.value;
+   });
+   // Baseline: the first action is only reachable once the whole vector is decoded
+   bench("first of 800 actions decoded vector baseline", 1, [&] {
+      eosio::input_stream                  stream{ bin };
+      std::vector<ship::transaction_trace> decoded;
+      eosio::from_bin(decoded, stream);
+      sink += std::get<1>(std::get<0>(decoded[0]).action_traces[0]).receiver.value;
+   });
+   bench("first of 800 actions trace_cursor", 1, [&] {
+      ship::trace_cursor cursor{ eosio::input_stream{ bin } };
+      cursor.next();
+      sink += std::get<1>(cursor.action()).receiver.value;
+   });
+}
+
+} // namespace
+
+int main() {
+   bench_integers();
+   bench_integer_action();
+   bench_batch();
+   bench_reorderable();
+   bench_names();
+   bench_assets();
+   bench_timestamps();
+   bench_base58();
+   bench_ripemd160();
+   bench_strings();
+   bench_varuints();
+   bench_fixed_structs();
+   bench_output_streams();
+   bench_converts();
+   bench_fd_streams();
+   bench_struct_keys();
+   bench_variants();
+   bench_decode_arena();
+   bench_skip_fields();
+   bench_blocks_result_decoder();
+   bench_table_deltas();
+   bench_trace_cursor();
+   return 0;
+}
@@ -1,6 +1,8 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <memory>
+#include "../include/eosio/base58.hpp"
 #include "../include/eosio/crypto.hpp"
 #include "../include/eosio/from_bin.hpp"
 #include "../include/eosio/from_json.hpp"
@@ -21,100 +23,50 @@ enum key_type : uint8_t {
     wa = 2,
 };
 
-constexpr char base58_chars[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
-
-constexpr auto create_base58_map() {
-    std::array<int8_t, 256> base58_map{{0}};
-    for (unsigned i = 0; i < base58_map.size(); ++i)
-        base58_map[i] = -1;
-    for (unsigned i = 0; i < sizeof(base58_chars); ++i)
-        base58_map[base58_chars[i]] = i;
-    return base58_map;
-}
-
-constexpr auto base58_map = create_base58_map();
-
-template <typename Container>
-void base58_to_binary(Container& result, std::string_view s) {
-    std::size_t offset = result.size();
-    for (auto& src_digit : s) {
-        int carry = base58_map[static_cast<uint8_t>(src_digit)];
-        check(carry >= 0,
-            ::eosio::convert_json_error(::eosio::from_json_error::expected_key));
-        for (std::size_t i = offset; i < result.size(); ++i) {
-            auto& result_byte = result[i];
-            int x = static_cast<uint8_t>(result_byte) * 58 + carry;
-            result_byte = x;
-            carry = x >> 8;
-        }
-        if (carry)
-            result.push_back(static_cast<uint8_t>(carry));
-    }
-    for (auto& src_digit : s)
-        if (src_digit == '1')
-            result.push_back(0);
-        else
-            break;
-    std::reverse(result.begin() + offset, result.end());
-}
-
-template <typename Container>
-std::string binary_to_base58(const Container& bin) {
-    std::string result("");
-    for (auto byte : bin) {
-        static_assert(sizeof(byte) == 1);
-        int carry = static_cast<uint8_t>(byte);
-        for (auto& result_digit : result) {
-            int x = (base58_map[result_digit] << 8) + carry;
-            result_digit = base58_chars[x % 58];
-            carry = x / 58;
-        }
-        while (carry) {
-            result.push_back(base58_chars[carry % 58]);
-            carry = carry / 58;
-        }
-    }
-    for (auto byte : bin)
-        if (byte)
-            break;
-        else
-            result.push_back('1');
-    std::reverse(result.begin(), result.end());
-    return result;
-}
-
-template <typename... Container>
-std::array<unsigned char, 20> digest_suffix_ripemd160(const Container&... data) {
-    std::array<unsigned char, 20> digest;
-    abieos_ripemd160::ripemd160_state self;
-    abieos_ripemd160::ripemd160_init(&self);
-    (abieos_ripemd160::ripemd160_update(&self, data.data(), data.size()), ...);
-    check( abieos_ripemd160::ripemd160_digest(&self, digest.data()),
-        convert_json_error(eosio::from_json_error::invalid_signature) );
-    return digest;
-}
-
-
 template <typename Key>
 Key string_to_key(std::string_view s, key_type type, std::string_view suffix) {
     std::vector<char> whole;
     whole.push_back(uint8_t{type});
-    base58_to_binary(whole, s);
-    check(whole.size() > 5,
-        convert_json_error(eosio::from_json_error::expected_key));
-    auto ripe_digest = digest_suffix_ripemd160(std::string_view(whole.data() + 1, whole.size() - 5), suffix);
-    check(memcmp(ripe_digest.data(), whole.data() + whole.size() - 4, 4)==0,
-        convert_json_error(from_json_error::expected_key));
-    whole.erase(whole.end() - 4, whole.end());
+    check(base58_check_to_binary(whole, s, suffix), convert_json_error(from_json_error::expected_key));
     return convert_from_bin<Key>(whole);
 }
 
 template <typename Key>
 std::string key_to_string(const Key& key, std::string_view suffix, const char* prefix) {
     auto whole = convert_to_bin(key);
-    auto ripe_digest = digest_suffix_ripemd160(std::string_view(whole.data() + 1, whole.size() - 1), suffix);
-    whole.insert(whole.end(), ripe_digest.data(), ripe_digest.data() + 4);
-    return prefix + binary_to_base58(std::string_view(whole.data() + 1, whole.size() - 1));
+    std::string result = prefix;
+    binary_to_base58_check(result, whole.data() + 1, whole.size() - 1, suffix);
+    return result;
+}
+
+constexpr const char* key_suffixes[] = {"K1", "R1", "WA"};
+
+// Converts count keys at once, hashing their checksums together with ripemd160_batch
+template <typename Key>
+void keys_to_strings(const Key* keys, size_t count, std::string* out, const char* const* prefixes,
+                     from_json_error error) {
+    std::vector<std::vector<char>> messages(count);
+    std::vector<const unsigned char*> data(count);
+    std::vector<size_t> sizes(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto index = keys[i].index();
+        check(index < std::variant_size_v<Key> && prefixes[index], convert_json_error(error));
+        auto& message = messages[i];
+        message = convert_to_bin(keys[i]);
+        message.erase(message.begin());
+        message.insert(message.end(), key_suffixes[index], key_suffixes[index] + 2);
+        data[i] = reinterpret_cast<const unsigned char*>(message.data());
+        sizes[i] = message.size();
+    }
+    std::unique_ptr<unsigned char[][abieos_ripemd160::ripemd160_digest_size]> digests(
+        new unsigned char[count][abieos_ripemd160::ripemd160_digest_size]);
+    abieos_ripemd160::ripemd160_batch(data.data(), sizes.data(), count, digests.get());
+    for (size_t i = 0; i < count; ++i) {
+        auto& message = messages[i];
+        out[i] = prefixes[keys[i].index()];
+        eosio::detail::binary_to_base58(out[i], reinterpret_cast<const uint8_t*>(message.data()), message.size() - 2,
+                                        digests[i], 4);
+    }
 }
 } // namespace
 
@@ -168,7 +120,7 @@ private_key eosio::private_key_from_string(std::string_view s) {
        __builtin_unreachable();
     } else {
         std::vector<char> whole;
-        base58_to_binary(whole, s);
+        check(base58_to_binary(whole, s), convert_json_error(eosio::from_json_error::expected_key));
         check(whole.size() >= 5, convert_json_error(from_json_error::expected_private_key));
         whole[0] = key_type::k1;
         whole.erase(whole.end() - 4, whole.end());
@@ -189,6 +141,16 @@ std::string eosio::signature_to_string(const eosio::signature& signature) {
     }
 }
 
+void eosio::public_keys_to_strings(const public_key* keys, size_t count, std::string* out) {
+    static constexpr const char* prefixes[] = {"PUB_K1_", "PUB_R1_", "PUB_WA_"};
+    keys_to_strings(keys, count, out, prefixes, from_json_error::expected_public_key);
+}
+
+void eosio::signatures_to_strings(const signature* signatures, size_t count, std::string* out) {
+    static constexpr const char* prefixes[] = {"SIG_K1_", "SIG_R1_", "SIG_WA_"};
+    keys_to_strings(signatures, count, out, prefixes, from_json_error::expected_signature);
+}
+
 signature eosio::signature_from_string(std::string_view s) {
     if (s.size() >= 7 && s.substr(0, 7) == "SIG_K1_")
         return string_to_key<signature>(s.substr(7), key_type::k1, "K1");
@@ -209,7 +171,7 @@ namespace eosio {
 
     std::vector<char> from_base58(const std::string_view& s) {
         std::vector<char> ret;
-        base58_to_binary(ret, s);
+        check(base58_to_binary(ret, s), convert_json_error(eosio::from_json_error::expected_key));
         return ret;
     }
 }
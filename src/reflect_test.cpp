@@ -1,6 +1,11 @@
 #include <eosio/reflection.hpp>
+#include <eosio/fixed_bin_size.hpp>
 #include <eosio/for_each_field.hpp>
+#include <eosio/from_bin.hpp>
+#include <eosio/to_bin.hpp>
+#include <eosio/to_json.hpp>
 #include <cstdio>
+#include <string>
 #include <string_view>
 
 int error_count;
@@ -29,6 +34,17 @@ struct outer {
    EOSIO_FRIEND_REFLECT(outer, i, j, k);
 };
 
+struct with_string {
+   outer       o;
+   std::string s;
+};
+EOSIO_REFLECT(with_string, o, s);
+
+struct derived : with_string {
+   int extra;
+};
+EOSIO_REFLECT(derived, base with_string, extra);
+
 int main() {
    int counter = 0;
    eosio::for_each_field<fn>([&](const char* name, auto method) { ++counter; });
@@ -43,5 +59,33 @@ int main() {
    counter = 0;
    eosio::for_each_field<outer>([&counter](const char* name, auto method) { ++counter; });
    CHECK(counter == 3);
+
+   CHECK(eosio::fixed_bin_size_v<outer::inner> == 4);
+   CHECK(eosio::fixed_bin_size_v<outer> == 12);
+   CHECK(eosio::fixed_bin_size_v<std::array<outer, 3>> == 36);
+   CHECK(eosio::fixed_bin_size_v<with_string> == 0);
+
+   outer o{ { 1 }, 2, 3 };
+   auto  bin = eosio::convert_to_bin(o);
+   CHECK(bin.size() == 12);
+   outer o2{};
+   eosio::input_stream in{ bin };
+   eosio::from_bin(o2, in);
+   CHECK(o2.i.i == 1 && o2.j == 2 && o2.k == 3 && in.remaining() == 0);
+   bool overrun = false;
+   try {
+      eosio::input_stream truncated{ bin.data(), bin.size() - 1 };
+      eosio::from_bin(o2, truncated);
+   } catch (std::exception&) {
+      overrun = true;
+   }
+   CHECK(overrun);
+
+   CHECK(eosio::convert_to_json(fn{}) == "{}");
+   CHECK(eosio::convert_to_json(o) == R"({"i":{"i":1},"j":2,"k":3})");
+   derived d{ { o, "x\"y" }, 4 };
+   CHECK(eosio::convert_to_json(d) == R"({"o":{"i":{"i":1},"j":2,"k":3},"s":"x\"y","extra":4})");
+   CHECK(eosio::format_json(outer::inner{ 1 }) == "{\n    \"i\": 1\n}");
+   CHECK(eosio::format_json(fn{}) == "{}");
    return error_count;
 }
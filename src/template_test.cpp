@@ -11,6 +11,8 @@
 #include <eosio/float.hpp>
 #include <eosio/varint.hpp>
 #include <eosio/abi.hpp>
+#include <eosio/base58.hpp>
+#include <random>
 
 int error_count;
 
@@ -70,6 +72,12 @@ void test(const T& value, eosio::abi& abi1, eosio::abi& abi2) {
       eosio::json_token_stream json_stream(mutable_json.data());
       from_json(json_value, json_stream);
       CHECK(json_value == value);
+      T indexed_value;
+      std::string indexed_json(json.data(), json.size());
+      eosio::json_structural_index index(indexed_json.data(), indexed_json.size());
+      eosio::json_token_stream indexed_stream(indexed_json.data(), &index);
+      from_json(indexed_value, indexed_stream);
+      CHECK(indexed_value == value);
    }
 
    for(eosio::abi* abi : {&abi1, &abi2})
@@ -118,6 +126,197 @@ using eosio::symbol;
 using eosio::symbol_code;
 using eosio::asset;
 
+// Tokenizes json with either the rapidjson reader or the structural index and
+// returns the token sequence, or the error that stopped it.
+std::string tokenize(const std::string& json, bool indexed) {
+   std::string mutable_json = json;
+   eosio::json_structural_index index;
+   if (indexed)
+      index.build(mutable_json.data(), mutable_json.size());
+   eosio::json_token_stream stream(mutable_json.data(), indexed ? &index : nullptr);
+   std::string result;
+   try {
+      do {
+         auto& t = stream.peek_token().get();
+         result += std::to_string(int(t.type)) + ":";
+         if (t.type == eosio::json_token_type::type_key)
+            result.append(t.key);
+         else if (t.type == eosio::json_token_type::type_string)
+            result.append(t.value_string);
+         else if (t.type == eosio::json_token_type::type_bool)
+            result += t.value_bool ? "true" : "false";
+         result += " ";
+         stream.eat_token();
+      } while (!stream.complete());
+   } catch (std::exception& e) {
+      result += std::string("error: ") + e.what();
+   }
+   return result;
+}
+
+void test_variant_dispatch() {
+   using v = std::variant<int, std::string, checksum256>;
+   CHECK(eosio::convert_to_json(v{ std::string{ "a\"" } }) == R"(["string","a\""])");
+   CHECK(eosio::format_json(v{ 7 }) == "[\n    \"int32\",\n    7\n]");
+   std::string json = R"(["checksum256","0000000000000000000000000000000000000000000000000000000000000001"])";
+   eosio::json_token_stream json_stream(json.data());
+   v from_json_value;
+   from_json(from_json_value, json_stream);
+   CHECK(from_json_value.index() == 2 && std::get<2>(from_json_value).extract_as_byte_array()[31] == 1);
+   for (const char* bad : { R"(["int64",1])", R"(["",1])" }) {
+      std::string bad_json = bad;
+      eosio::json_token_stream bad_stream(bad_json.data());
+      bool threw = false;
+      try {
+         from_json(from_json_value, bad_stream);
+      } catch (std::exception&) {
+         threw = true;
+      }
+      CHECK(threw);
+   }
+   for (char tag : { 3, 127 }) {
+      eosio::input_stream bad_stream(&tag, 1);
+      bool threw = false;
+      try {
+         from_bin(from_json_value, bad_stream);
+      } catch (std::exception&) {
+         threw = true;
+      }
+      CHECK(threw);
+   }
+}
+
+void test_json_index() {
+   std::string long_string(200, 'x');
+   for (const std::string& json : std::initializer_list<std::string>{
+            "", " ", "true", " false ", "null", "trues", "nul", "1", "-0", "-", "01", "1.", "1.5e", "1.5e+7", "-12.5E-3",
+            "12ab", R"("")", R"("abc")", R"("abc)", R"("abc"x)", R"("a\"b\\c\/d\b\f\n\r\t")", R"("Aé中")",
+            R"("😀")", R"("\ud83d")", R"("\ude00")", R"("\u12G4")", R"("\q")", "\"a\x01" "b\"", "\"\xc3\xa9\"",
+            "\"\xff\"", "\"\xe0\x80\x80\"", "\"\xed\xa0\x80\"", "[]", "{}", "[1,2,[3,{}]]", "[1 2]", "[1,]", "[,1]", "[1",
+            R"({"a":1,"b":[true,false,null],"c":{"d":"e"}})", R"({"a" 1})", R"({"a":1 "b":2})", R"({"a":1,})",
+            R"({1:2})", R"({"a":})", R"({"a")", "{\"a\":\"" + long_string + "\"}",
+            "[\"" + long_string + "\\n" + long_string + "\"]", "[\"" + long_string + "\xc3\xa9" + long_string + "\"]",
+            "[\"" + long_string + "\\\\\", \"" + long_string + "\"]", "[1] [2]", "{} x", " [ 1 , 2 ] \n"}) {
+      CHECK(tokenize(json, false) == tokenize(json, true));
+   }
+   // Parsing stops at the first NUL, however many follow it in the block
+   for (const std::string& json : std::initializer_list<std::string>{
+            std::string("1\0 \0", 4), std::string("[1]\0\0\0", 6), std::string("\0\0x", 3),
+            std::string("[1]\0 \0x\0", 8) + std::string(100, ' '), "\"" + long_string + "\"" + std::string("\0 \0\0", 4)}) {
+      CHECK(tokenize(json, false) == tokenize(json, true));
+   }
+}
+
+// Decodes a varuint from `encoded` followed by `padding` bytes, returning "value size" or the
+// error. Short buffers take the checked loop and 5 (varuint32) or 10 (varuint64) readable bytes the
+// unchecked path. The padding has the continuation bit set, so it never ends a value by accident.
+template <typename T>
+std::string decode_varuint(const std::string& encoded, size_t padding) {
+   std::string         bin = encoded + std::string(padding, '\xff');
+   eosio::input_stream stream(bin.data(), bin.size());
+   try {
+      T value;
+      if constexpr (std::is_same_v<T, uint32_t>)
+         eosio::varuint32_from_bin(value, stream);
+      else
+         eosio::varuint64_from_bin(value, stream);
+      return std::to_string(value) + " " + std::to_string(stream.pos - bin.data());
+   } catch (std::exception& e) { return std::string("error: ") + e.what(); }
+}
+
+void test_varuint() {
+   auto encode = [](uint64_t value) {
+      std::string result;
+      do {
+         result += char((value & 0x7f) | (value > 0x7f ? 0x80 : 0));
+         value >>= 7;
+      } while (value);
+      return result;
+   };
+   auto invalid = "error: " + std::string(eosio::convert_stream_error(eosio::stream_error::invalid_varuint_encoding));
+   auto overrun = "error: " + std::string(eosio::convert_stream_error(eosio::stream_error::overrun));
+   for (size_t padding = 0; padding <= 16; ++padding) {
+      // The smallest and largest value of every length
+      for (int bytes = 1; bytes <= 10; ++bytes) {
+         uint64_t lo = bytes == 1 ? 0 : uint64_t(1) << (7 * (bytes - 1));
+         uint64_t hi = bytes == 10 ? ~uint64_t(0) : (uint64_t(1) << (7 * bytes)) - 1;
+         for (uint64_t value : { lo, hi }) {
+            auto expected = std::to_string(value) + " " + std::to_string(bytes);
+            CHECK(decode_varuint<uint64_t>(encode(value), padding) == expected);
+            if (value <= 0xffff'ffff)
+               CHECK(decode_varuint<uint32_t>(encode(value), padding) == expected);
+         }
+      }
+      CHECK(decode_varuint<uint32_t>(encode(0xffff'ffff), padding) == "4294967295 5");
+
+      // A varuint32's fifth byte and a varuint64's tenth keep only the bits which fit
+      CHECK(decode_varuint<uint32_t>("\xff\xff\xff\xff\x7f", padding) == "4294967295 5");
+      CHECK(decode_varuint<uint32_t>("\x80\x80\x80\x80\x10", padding) == "0 5");
+      CHECK(decode_varuint<uint64_t>(std::string(9, '\xff') + "\x7f", padding) == "18446744073709551615 10");
+      CHECK(decode_varuint<uint64_t>(std::string(9, '\x80') + "\x02", padding) == "0 10");
+
+      // Overlong encodings
+      CHECK(decode_varuint<uint32_t>(std::string(5, '\x80') + '\0', padding) == invalid);
+      CHECK(decode_varuint<uint64_t>(std::string(10, '\x80') + '\0', padding) == invalid);
+   }
+   // Values cut off by the end of the buffer
+   for (size_t bytes = 1; bytes <= 9; ++bytes) {
+      CHECK(decode_varuint<uint64_t>(std::string(bytes, '\x80'), 0) == overrun);
+      if (bytes < 5)
+         CHECK(decode_varuint<uint32_t>(std::string(bytes, '\x80'), 0) == overrun);
+   }
+}
+
+// Quadratic reference encoder, one byte of input at a time
+std::string reference_base58(const std::string& bin) {
+   std::vector<uint8_t> digits; // little-endian
+   for (uint8_t b : bin) {
+      unsigned carry = b;
+      for (auto& d : digits) {
+         carry += d * 256;
+         d     = carry % 58;
+         carry /= 58;
+      }
+      for (; carry; carry /= 58) digits.push_back(carry % 58);
+   }
+   std::string result;
+   for (size_t i = 0; i < bin.size() && !bin[i]; ++i) result += '1';
+   for (size_t i = digits.size(); i-- > 0;) result += eosio::base58_chars[digits[i]];
+   return result;
+}
+
+void test_base58() {
+   CHECK(eosio::binary_to_base58("") == "");
+   CHECK(eosio::binary_to_base58("Hello World!") == "2NEpo7TZRRrLZSi2U");
+   CHECK(eosio::binary_to_base58(std::string("\0\0\x01\x02", 4)) == "115T");
+
+   // From empty to several limbs and past the limbs kept on the stack, with leading zero bytes
+   std::mt19937 rng;
+   for (size_t size : { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 31, 32, 33, 69, 100, 400, 1000 }) {
+      for (size_t zeros = 0; zeros <= 3; ++zeros) {
+         std::string bin(zeros, '\0');
+         for (size_t i = 0; i < size; ++i) bin += char(rng());
+         auto s = eosio::binary_to_base58(bin);
+         CHECK(s == reference_base58(bin));
+         std::string decoded;
+         CHECK(eosio::base58_to_binary(decoded, s) && decoded == bin);
+
+         std::string checked = "x";
+         eosio::binary_to_base58_check(checked, bin.data(), bin.size(), "K1");
+         std::string checked_decoded, wrong_suffix;
+         CHECK(eosio::base58_check_to_binary(checked_decoded, checked.substr(1), "K1") == !bin.empty());
+         CHECK(checked_decoded == bin);
+         CHECK(!eosio::base58_check_to_binary(wrong_suffix, checked.substr(1), "R1") && wrong_suffix.empty());
+      }
+   }
+
+   for (char c : { '0', 'O', 'I', 'l', '+', '/', ' ', '\0', '\xff' }) {
+      std::vector<char> decoded{ 'x' };
+      CHECK(!eosio::base58_to_binary(decoded, std::string("2NEpo") + c + "7TZ") && decoded == std::vector<char>{ 'x' });
+      CHECK(!eosio::base58_check_to_binary(decoded, std::string("2NEpo") + c + "7TZ", "K1") && decoded.size() == 1);
+   }
+}
+
 using vec_type = std::vector<int>;
 struct struct_type {
    std::vector<int> v;
@@ -235,5 +434,10 @@ int main() {
    test(std::vector{1, 2}, abi, new_abi);
    test(std::optional{3}, abi, new_abi);
    test(std::variant<int, double>{4}, abi, new_abi);
+   test(std::variant<int, double>{4.5}, abi, new_abi);
+   test_variant_dispatch();
+   test_json_index();
+   test_varuint();
+   test_base58();
    if(error_count) return 1;
 }
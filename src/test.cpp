@@ -2,6 +2,12 @@
 
 #include <eosio/abieos.h>
 #include <eosio/abieos.hpp>
+#include <eosio/fd_stream.hpp>
+#include <eosio/ship_protocol_arena.hpp>
+#include <eosio/ship_delta_decoder.hpp>
+#include <eosio/ship_protocol_view.hpp>
+#include <eosio/ship_result_decoder.hpp>
+#include <eosio/ship_trace_cursor.hpp>
 #include "fuzzer.hpp"
 #include "rapidjson/document.h"
 #include "rapidjson/stringbuffer.h"
@@ -618,6 +624,19 @@ void check_error(abieos_context* context, const std::string& s, F f) {
     check_except(s, [&] { check_context(context, f()); });
 }
 
+// Like check_except, but the message must match
+template <typename F>
+void check_throws(const std::string& s, F f) {
+    try {
+        f();
+    } catch (std::exception& e) {
+        if (e.what() != s)
+            throw std::runtime_error("expected exception: " + s + " got: " + e.what());
+        return;
+    }
+    throw std::runtime_error("expected exception: " + s);
+}
+
 void check_types() {
     auto context = check(abieos_create());
     auto token = check_context(context, abieos_string_to_name(context, "eosio.token"));
@@ -790,6 +809,11 @@ void check_types() {
     check_type(context, 0, "uint128", R"("0")");
     check_type(context, 0, "uint128", R"("1")");
     check_type(context, 0, "uint128", R"("18446744073709551615")");
+    check_type(context, 0, "uint128", R"("18446744073709551616")");
+    check_type(context, 0, "uint128", R"("10000000000000000000000000000000000001")");
+    check_type(context, 0, "uint128", R"("99999999999999999999999999999999999999")");
+    check_type(context, 0, "uint128", R"("100000000000000000000000000000000000000")");
+    check_type(context, 0, "int128", R"("-100000000000000000090000000000000000007")");
     check_type(context, 0, "uint128", R"("340282366920938463463374607431768211454")");
     check_type(context, 0, "uint128", R"("340282366920938463463374607431768211455")");
     check_error(context, "number is out of range",
@@ -857,6 +881,14 @@ void check_types() {
     check_type(context, 0, "time_point", R"("2018-06-15T19:17:47.999")");
     check_type(context, 0, "time_point", R"("2030-06-15T19:17:47.999")");
     check_type(context, 0, "time_point", R"("2000-12-31T23:59:59.999999")", R"("2000-12-31T23:59:59.999")");
+    check_type(context, 0, "time_point[]",
+               R"(["2018-06-15T23:59:59.999","2018-06-16T00:00:00.000","2018-06-15T00:00:00.000","2100-02-28T12:00:00.000"])");
+    check_error(context, "expected string containing time_point",
+                [&] { return abieos_json_to_bin(context, 0, "time_point", R"("2018-06-15 19:17:47.000")"); });
+    check_error(context, "expected string containing time_point",
+                [&] { return abieos_json_to_bin(context, 0, "time_point", R"("2018-06-15T19:17")"); });
+    check_error(context, "expected string containing time_point",
+                [&] { return abieos_json_to_bin(context, 0, "time_point", R"("2018-06-15T19:1a:47")"); });
     check_error(context, "expected string containing time_point",
                 [&] { return abieos_json_to_bin(context, 0, "time_point", "true"); });
     check_type(context, 0, "block_timestamp_type", R"("2000-01-01T00:00:00.000")");
@@ -873,6 +905,24 @@ void check_types() {
     check_type(context, 0, "name", R"("ab.cd.ef.1234")");
     check_type(context, 0, "name", R"("..ab.cd.ef..")", R"("..ab.cd.ef")");
     check_type(context, 0, "name", R"("zzzzzzzzzzzz")");
+    check_type(context, 0, "name", R"("zzzzzzzzzzzzj")");
+    check_type(context, 0, "name", R"("eosio.token")");
+    check_type(context, 0, "name[]", R"(["eosio","","eosio","a.1"])");
+    {
+        std::string_view strs[] = {"", "eosio.token", "zzzzzzzzzzzzj", "a.b..", "ab", "zzzzzzzzzzzzk", "abc"};
+        uint64_t names[std::size(strs)];
+        if (eosio::strings_to_names(strs, std::size(strs), names) != 5)
+            throw std::runtime_error("strings_to_names did not stop at the invalid name");
+        char chars[13 * 5];
+        std::string_view out[5];
+        eosio::names_to_strings(names, 5, chars, out);
+        if (out[0] != "" || out[1] != "eosio.token" || out[2] != "zzzzzzzzzzzzj" || out[3] != "a.b" || out[4] != "ab")
+            throw std::runtime_error("names_to_strings mismatch");
+        std::string_view bad[] = {"Ab", "abcdefghijklmn", "a b"};
+        for (auto& b : bad)
+            if (eosio::strings_to_names(&b, 1, names) != 0)
+                throw std::runtime_error("strings_to_names accepted " + std::string(b));
+    }
     // todo: should json conversion fall back to hash? reenable this error?
     // check_error(context, "thirteenth character in name cannot be a letter that comes after j",
     //             [&] { return abieos_json_to_bin(context, 0, "name", R"("zzzzzzzzzzzzz")"); });
@@ -906,6 +956,10 @@ void check_types() {
     check(abieos_bin_to_json(context, 0, "string", "\x08\xe8\xbf\x99\b\f\n\r\t", 9) ==
               std::string("\"\xe8\xbf\x99\\b\\f\\n\\r\\t\""),
           "escaping");
+    check(abieos_bin_to_json(context, 0, "string",
+                             "\x1f" "0123456789abcdef\"x\xe2\x82\"\xed\xa0\x80\xc0\xaf\xf0\x9f\x98\x80\x7f", 32) ==
+              std::string("\"0123456789abcdef\\\"x??\\\"?????\xf0\x9f\x98\x80\\u007F\""),
+          "escaping across chunks");
     check_error(context, "Stream overrun", [&] { return abieos_hex_to_json(context, 0, "string", "01"); });
     check_type(context, 0, "checksum160", R"("0000000000000000000000000000000000000000")");
     check_type(context, 0, "checksum160", R"("123456789ABCDEF01234567890ABCDEF70123456")");
@@ -991,6 +1045,46 @@ void check_types() {
     check_type(
         context, 0, "signature",
         R"("SIG_WA_FejsRu4VrdwoZ27v2D3wmp4Kge46JJSqWsiMgbJapVuuYnPDyZZjJSTggdHUNPMp3zt2fGfAdpWY7ScsohZzWTJ1iTerbab2pNE6Tso7MJRjdMAG56K4fjrASEK6QsUs7rxG9Syp7kstBcq8eZidayrtK9YSH1MCNTAqrDPMbN366vR8q5XeN5BSDmyDsqmjsMMSKWMeEbUi7jNHKLziZY6dKHNqDYqjmDmuXoevxyDRWrNVHjAzvBtfTuVtj2r5tCScdCZ3a7yQ1D2zZvstphB4t5HN9YXw1HGS3yKCY6uRZ2V")");
+    {
+        std::vector<std::string> strs = {
+            "SIG_K1_Kg2UKjXTX48gw2wWH4zmsZmWu3yarcfC21Bd9JPj7QoDURqiAacCHmtExPk3syPb2tFLsp1R4ttXLXgr7FYgDvKPC5RCkx",
+            "SIG_R1_Kfh19CfEcQ6pxkMBz6xe9mtqKuPooaoyatPYWtwXbtwHUHU8YLzxPGvZhkqgnp82J41e9R6r5mcpnxy1wAf1w9Vyo9wybZ",
+            "SIG_WA_FjWGWXz7AC54NrVWXS8y8DGu1aesCr7oFiFmVg4a1QfNS74JwaVkqkN8xbMD64uvcsmPvtNnA9du6G6nSsWuyT9tM8CQw9mV1BSbWEs8hjF1uFBP1QHAEadvhkZQPU1FTyPMz4jevaHYMQgfMiAf3QoPhPn9RGxzvNph8Zrd6F3pKpZkUe92tGQU8PQvEMa22ELPvdXzxXC6qUKnKVSH4gK7BXw168jb5d3nnWrpQ1yrLTWB4xizEMpN8sTfsgScKKx1QajX2uNUahQEb1cxipQZbVMApifHEUsK45PqsNxfXvb",
+        };
+        while (strs.size() < 11)
+            strs.push_back(strs[strs.size() % 3]);
+        std::vector<eosio::signature> sigs;
+        std::string json = "[";
+        for (auto& str : strs) {
+            sigs.push_back(eosio::signature_from_string(str));
+            json += (json.size() > 1 ? ",\"" : "\"") + str + "\"";
+        }
+        json += "]";
+        std::vector<std::string> out(sigs.size());
+        eosio::signatures_to_strings(sigs.data(), sigs.size(), out.data());
+        if (out != strs || eosio::convert_to_json(sigs) != json)
+            throw std::runtime_error("signatures_to_strings mismatch");
+
+        std::vector<unsigned char> msg(300);
+        for (size_t i = 0; i < msg.size(); ++i)
+            msg[i] = i * 7;
+        size_t sizes[] = {0, 1, 55, 56, 63, 64, 119, 120, 128, 200, 300};
+        const unsigned char* data[std::size(sizes)];
+        unsigned char digests[std::size(sizes)][20];
+        for (auto& d : data)
+            d = msg.data();
+        abieos_ripemd160::ripemd160_batch(data, sizes, std::size(sizes), digests);
+        for (size_t i = 0; i < std::size(sizes); ++i) {
+            abieos_ripemd160::ripemd160_state state;
+            abieos_ripemd160::ripemd160_init(&state);
+            if (sizes[i])
+                abieos_ripemd160::ripemd160_update(&state, msg.data(), sizes[i]);
+            unsigned char digest[20];
+            abieos_ripemd160::ripemd160_digest(&state, digest);
+            if (memcmp(digest, digests[i], 20))
+                throw std::runtime_error("ripemd160_batch mismatch at size " + std::to_string(sizes[i]));
+        }
+    }
     check_error(context, "expected string containing signature",
                 [&] { return abieos_json_to_bin(context, 0, "signature", "true"); });
     check_error(context, "unrecognized signature format",
@@ -1011,6 +1105,23 @@ void check_types() {
     check_type(context, 0, "asset", R"("0.000 FOO")");
     check_type(context, 0, "asset", R"("1.2345 SYS")");
     check_type(context, 0, "asset", R"("-1.2345 SYS")");
+    check_type(context, 0, "asset", R"("92233720368547758.07 FOO")");
+    check_type(context, 0, "asset", R"("-92233720368547758.08 FOO")");
+    check_type(context, 0, "asset", R"("9223372036854775807 FOO")");
+    check_type(context, 0, "asset", R"("0.00000000000000000000000000000001 FOO")");
+    check_type(context, 0, "asset", R"("-0.01 ABCDEFG")");
+    check_type(context, 0, "symbol", R"("18,ABCDEFG")");
+    // Symbol codes from binary aren't validated, so they may still need escaping
+    if (check_context(context, abieos_hex_to_json(context, 0, "symbol_code", "2261000000000000")) !=
+        std::string(R"("\"a")"))
+        throw std::runtime_error("symbol_code was not escaped");
+    if (check_context(context, abieos_hex_to_json(context, 0, "asset", "01000000000000000222610000000000")) !=
+        std::string(R"("0.01 \"a")"))
+        throw std::runtime_error("asset symbol was not escaped");
+    check_error(context, "expected symbol code",
+                [&] { return abieos_json_to_bin(context, 0, "asset", R"("92233720368547758.08 FOO")"); });
+    check_error(context, "expected symbol code",
+                [&] { return abieos_json_to_bin(context, 0, "asset", R"("1000000000000000000000 FOO")"); });
     check_error(context, "expected string containing asset",
                 [&] { return abieos_json_to_bin(context, 0, "asset", "null"); });
     check_type(context, 0, "asset[]", R"([])");
@@ -1031,6 +1142,23 @@ void check_types() {
         context, token, "transfer",
         R"({"to":"useraaaaaaab","memo":"test memo","from":"useraaaaaaaa","quantity":"0.0001 SYS"})",
         R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"0.0001 SYS","memo":"test memo"})", false);
+    check_type( //
+        context, token, "transfer",
+        R"({"from":"useraaaaaaaa","extra":{"x":[1,{}]},"memo":"test memo","to":"useraaaaaaab","quantity":"0.0001 SYS"})",
+        R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"0.0001 SYS","memo":"test memo"})", false);
+    check_type( //
+        context, token, "transfer",
+        R"({"from":"useraaaaaaaa","to":"","memo":"x","quantity":"0.0001 SYS","to":"useraaaaaaab","memo":"test memo"})",
+        R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"0.0001 SYS","memo":"test memo"})", false);
+    check_type(
+        context, 0, "transaction",
+        R"({"actions":[{"data":"608C31C6187315D6708C31C6187315D60100000000000000045359530000000000","authorization":[{"permission":"active","actor":"useraaaaaaaa"}],"name":"transfer","account":"eosio.token"}],"expiration":"2009-02-13T23:31:31.000","ref_block_num":1234,"ref_block_prefix":5678,"max_net_usage_words":0,"max_cpu_usage_ms":0,"delay_sec":0,"context_free_actions":[],"transaction_extensions":[]})",
+        R"({"expiration":"2009-02-13T23:31:31.000","ref_block_num":1234,"ref_block_prefix":5678,"max_net_usage_words":0,"max_cpu_usage_ms":0,"delay_sec":0,"context_free_actions":[],"actions":[{"account":"eosio.token","name":"transfer","authorization":[{"actor":"useraaaaaaaa","permission":"active"}],"data":"608C31C6187315D6708C31C6187315D60100000000000000045359530000000000"}],"transaction_extensions":[]})",
+        false);
+    check_error(context, "Expected field", [&] {
+        return abieos_json_to_bin_reorderable(context, token, "transfer",
+                                              R"({"to":"useraaaaaaab","from":"useraaaaaaaa","memo":""})");
+    });
     check_type(
         context, 0, "transaction",
         R"({"ref_block_num":1234,"ref_block_prefix":5678,"expiration":"2009-02-13T23:31:31.000","max_net_usage_words":0,"max_cpu_usage_ms":0,"delay_sec":0,"context_free_actions":[],"actions":[{"account":"eosio.token","name":"transfer","authorization":[{"actor":"useraaaaaaaa","permission":"active"}],"data":"608C31C6187315D6708C31C6187315D60100000000000000045359530000000000"}],"transaction_extensions":[]})",
@@ -1289,6 +1417,33 @@ void check_types() {
     if(kv_table_primary_index_name != "by.id")
         throw std::runtime_error("kv_table primary name mismatch");
 
+    auto check_batch = [&](int count, const char* expected_hex, std::vector<std::pair<size_t, size_t>> expected_items) {
+        if (count != int(expected_items.size()))
+            throw std::runtime_error("batch count mismatch");
+        std::string hex = check_context(context, abieos_get_bin_hex(context));
+        if (hex != expected_hex)
+            throw std::runtime_error("batch binary mismatch: " + hex);
+        for (size_t i = 0; i < expected_items.size(); ++i) {
+            size_t offset = 0, size = 0;
+            bool ok = abieos_get_batch_item(context, i, &offset, &size);
+            if (ok != (expected_items[i].second != 0) || (ok && std::make_pair(offset, size) != expected_items[i]))
+                throw std::runtime_error("batch item mismatch");
+        }
+        if (abieos_get_batch_item(context, expected_items.size(), nullptr, nullptr))
+            throw std::runtime_error("batch index out of range not detected");
+    };
+
+    std::string ndjson = "1\n\n32768\r\n\"foo\"\n-2";
+    check_batch(abieos_json_to_bin_ndjson(context, 0, "int16", ndjson.data(), ndjson.size()), "020100" "02FEFF",
+                {{1, 2}, {0, 0}, {0, 0}, {4, 2}});
+    check_error(context, "number is out of range", [&] { return abieos_get_batch_item(context, 1, nullptr, nullptr); });
+    const char* docs[] = {R"([1,2])", R"([3,)", R"([])"};
+    size_t doc_sizes[] = {strlen(docs[0]), strlen(docs[1]), strlen(docs[2])};
+    check_batch(abieos_json_to_bin_batch(context, 0, "int8[]", docs, doc_sizes, 3), "03020102" "0100", //
+                {{1, 3}, {0, 0}, {5, 1}});
+    if (abieos_json_to_bin_ndjson(context, 8888, "int8", "1", 1) != -1)
+        throw std::runtime_error("batch with unknown contract did not fail");
+
     auto check_checksum_capacity = [&](const auto& checksum, size_t capacity, const char* msg) {
         if(checksum.capacity() != capacity)
             throw std::runtime_error(std::string{msg} + " capacity test failed");
@@ -1417,11 +1572,683 @@ void test_abi_kv_table() {
     }
 }
 
+void check_segmented_stream() {
+    // Pages far smaller than the output, so writes of every size cross page boundaries
+    eosio::page_pool pool{7};
+    std::vector<std::string> strs;
+    for (int i = 0; i < 100; ++i)
+        strs.push_back(std::string(i % 17, 'a' + i % 26));
+    std::vector<char> expected;
+    eosio::vector_stream vs{expected};
+    eosio::to_json(strs, vs);
+    for (int round = 0; round < 2; ++round) {
+        eosio::segmented_stream ss{pool};
+        eosio::to_json(strs, ss);
+        std::string flat(ss.size(), 0);
+        ss.copy_to(flat.data());
+        std::string joined;
+        for (auto seg : ss.segments())
+            joined += seg;
+        if (flat != std::string(expected.begin(), expected.end()) || joined != flat)
+            throw std::runtime_error("segmented_stream mismatch");
+        ss.clear();
+        if (ss.size() != 0 || !ss.segments().empty())
+            throw std::runtime_error("segmented_stream clear");
+    }
+
+    // A large output leaves no more than max_free_pages behind in the pool
+    eosio::page_pool capped{7, 4};
+    {
+        eosio::segmented_stream ss{capped};
+        eosio::to_json(strs, ss);
+    }
+    if (capped.free_pages() != 4)
+        throw std::runtime_error("page_pool kept too many pages");
+}
+
+void check_convert_modes() {
+    using eosio::convert_mode;
+    // Alternate short and long values so single_pass both over-reserves and outgrows its size hint
+    for (size_t n : {0, 1, 300, 2, 5000, 0}) {
+        std::vector<std::string> strs;
+        for (size_t i = 0; i < n; ++i)
+            strs.push_back(std::string(i % 23, char('a' + i % 26)));
+        auto json   = eosio::convert_to_json(strs, convert_mode::two_pass);
+        auto pretty = eosio::format_json(strs, convert_mode::two_pass);
+        auto bin    = eosio::convert_to_bin(strs, convert_mode::two_pass);
+        if (eosio::convert_to_json(strs, convert_mode::single_pass) != json || eosio::convert_to_json(strs) != json ||
+            eosio::format_json(strs, convert_mode::single_pass) != pretty || eosio::format_json(strs) != pretty ||
+            eosio::convert_to_bin(strs, convert_mode::single_pass) != bin || eosio::convert_to_bin(strs) != bin)
+            throw std::runtime_error("convert modes disagree");
+    }
+    std::vector<char> bin{'x'};
+    eosio::convert_to_bin(eosio::name{"eosio"}, bin, convert_mode::single_pass);
+    if (bin.size() != 9 || bin[0] != 'x' || eosio::convert_to_bin(eosio::name{"eosio"}) != std::vector<char>(bin.begin() + 1, bin.end()))
+        throw std::runtime_error("convert_to_bin fixed size");
+
+    // A small value after a large one must not keep the large one's reservation
+    std::vector<std::string> large(100000, std::string(50, 'x'));
+    std::vector<std::string> small{"x"};
+    for (auto mode : {convert_mode::automatic, convert_mode::single_pass}) {
+        eosio::convert_to_json(large, mode);
+        eosio::convert_to_bin(large, convert_mode::single_pass);
+        auto json = eosio::convert_to_json(small, mode);
+        auto bin  = eosio::convert_to_bin(small, convert_mode::single_pass);
+        if (json != R"(["x"])" || json.capacity() > 4096 || bin.size() != 3 || bin.capacity() > 4096)
+            throw std::runtime_error("single_pass kept a large reservation");
+    }
+}
+
+void check_fd_stream() {
+    auto read_back = [](FILE* f) {
+        std::string result;
+        rewind(f);
+        for (int c; (c = getc(f)) != EOF;)
+            result += char(c);
+        fclose(f);
+        return result;
+    };
+
+    // Small buffers, so single writes, large writes and segments all cross buffer boundaries
+    std::vector<std::string> strs;
+    for (int i = 0; i < 1000; ++i)
+        strs.push_back(std::string(i % 37, char('a' + i % 26)));
+    for (size_t buffer_size : {1, 7, 64, 4096}) {
+        FILE* f = tmpfile();
+        {
+            eosio::fd_stream out{fileno(f), buffer_size};
+            eosio::to_json(strs, out);
+            eosio::to_bin(strs, out);
+        }
+        if (read_back(f) != eosio::convert_to_json(strs) + std::string(eosio::convert_to_bin(strs).data(), eosio::convert_to_bin(strs).size()))
+            throw std::runtime_error("fd_stream mismatch");
+    }
+
+    // The dynamic engine flushes page by page
+    abieos::abi abi{std::string{R"({"version": "eosio::abi/1.1", "structs": [
+        {"name": "s", "base": "", "fields": [{"name": "a", "type": "int8[]"}, {"name": "n", "type": "name"}]}]})"}};
+    std::vector<char> bin;
+    eosio::vector_stream bin_stream{bin};
+    eosio::varuint32_to_bin(200000, bin_stream);
+    for (int i = 0; i < 200000; ++i)
+        bin.push_back(char(i));
+    eosio::to_bin(eosio::name{"eosio"}, bin_stream);
+    auto t = abi.get_type("s");
+    FILE* f = tmpfile();
+    {
+        eosio::fd_stream out{fileno(f), 1000};
+        t->bin_to_json(eosio::input_stream{bin}, out);
+        out.flush();
+        if (out.written != t->bin_to_json(eosio::input_stream{bin}).size())
+            throw std::runtime_error("fd_stream written");
+    }
+    if (read_back(f) != t->bin_to_json(eosio::input_stream{bin}))
+        throw std::runtime_error("bin_to_json fd_stream mismatch");
+
+    // So is a single value larger than a page
+    abieos::abi blob_abi{std::string{R"({"version": "eosio::abi/1.1", "structs": [
+        {"name": "s", "base": "", "fields": [{"name": "b", "type": "bytes"}]}]})"}};
+    struct counting_sink {
+        size_t total = 0, largest = 0;
+        void write_segments(const eosio::segmented_stream& s) {
+            total += s.size();
+            largest = std::max(largest, s.size());
+        }
+    } sink;
+    auto blob = eosio::convert_to_bin(eosio::bytes{std::vector<char>(300000, 'x')});
+    eosio::input_stream blob_stream{blob};
+    abieos::bin_to_json(blob_stream, blob_abi.get_type("s"), sink, [] {});
+    if (sink.total != 600008 || sink.largest > eosio::page_pool::default_page_size)
+        throw std::runtime_error("bin_to_json held a large value whole");
+
+    eosio::fd_stream bad{-1};
+    bad.write('x');
+    check_throws("Error writing to file descriptor", [&] { bad.flush(); });
+    check_throws("fd_stream buffer_size must be positive", [] { eosio::fd_stream{1, 0}; });
+}
+
+// An action_trace_v1 with its optional members and vectors filled in
+eosio::ship_protocol::action_trace_v1 make_sample_action() {
+    namespace ship = eosio::ship_protocol;
+    ship::action_trace_v1 action;
+    action.receipt = ship::action_receipt_v0{eosio::name{"alice"}, {}, 1, 2, {{eosio::name{"alice"}, 7}}};
+    action.act.authorization = {{eosio::name{"alice"}, eosio::name{"active"}}};
+    action.console = "hello";
+    action.account_ram_deltas = {{eosio::name{"bob"}, -5}};
+    action.account_disk_deltas = {{eosio::name{"alice"}, 3}};
+    action.except = "boom";
+    action.return_value = eosio::input_stream{"ret", 3};
+    return action;
+}
+
+// `count` copies of a transaction trace with two copies of `action`, which also failed a deferred
+// transaction holding the same two actions
+std::vector<eosio::ship_protocol::transaction_trace>
+make_sample_traces(size_t count, const eosio::ship_protocol::action_trace_v1& action = make_sample_action()) {
+    namespace ship = eosio::ship_protocol;
+    ship::transaction_trace_v0 inner;
+    inner.action_traces = {action, action};
+    ship::transaction_trace_v0 trace = inner;
+    trace.account_ram_delta = ship::account_delta{eosio::name{"alice"}, 5};
+    trace.except = "failed";
+    trace.failed_dtrx_trace.push_back({inner});
+    trace.partial = ship::partial_transaction_v0{};
+    return std::vector<ship::transaction_trace>(count, trace);
+}
+
+// A signed_block_v1 with a new producer schedule, header extensions and a transaction for each
+// prunable_data alternative, or a signed_block_v0 with one packed_transaction_v0
+eosio::ship_protocol::signed_block_variant make_sample_block(bool v1) {
+    namespace ship = eosio::ship_protocol;
+    ship::signed_block_header header;
+    header.producer = eosio::name{"bob"};
+    header.new_producers = ship::producer_schedule{2, {{eosio::name{"bob"}, eosio::public_key{}}}};
+    header.header_extensions = {{1, eosio::input_stream{"ext", 3}}};
+    if (!v1) {
+        ship::signed_block_v0 block{header};
+        ship::packed_transaction_v0 trx{{eosio::signature{}}, 0, eosio::input_stream{"cfd", 3}, eosio::input_stream{"trx", 3}};
+        block.transactions = {{{}, trx}, {{}, eosio::checksum256{}}};
+        return block;
+    }
+    ship::signed_block_v1 block{header};
+    block.prune_state = 1;
+    for (ship::prunable_data_t prunable : std::initializer_list<ship::prunable_data_t>{
+             ship::prunable_data_full_legacy{{eosio::signature{}}, eosio::input_stream{"cfd", 3}},
+             ship::prunable_data_none{},
+             ship::prunable_data_partial{{eosio::signature{}}, {eosio::checksum256{}, eosio::input_stream{"cfd", 3}}},
+             ship::prunable_data_full{{eosio::signature{}}, {eosio::input_stream{"cfd", 3}}}}) {
+        ship::packed_transaction trx;
+        trx.prunable_data.prunable_data = prunable;
+        trx.packed_trx = eosio::input_stream{"trx", 3};
+        block.transactions.push_back({{}, trx});
+    }
+    block.transactions.push_back({{}, eosio::checksum256{}});
+    block.block_extensions = {{2, eosio::input_stream{"blk", 3}}};
+    return block;
+}
+
+std::vector<eosio::ship_protocol::table_delta> make_sample_deltas() {
+    namespace ship = eosio::ship_protocol;
+    return {ship::table_delta_v0{"account", {{true, eosio::input_stream{"row", 3}}, {false, {}}}},
+            ship::table_delta_v1{"contract_row", {{2, eosio::input_stream{"new", 3}}, {1, eosio::input_stream{"old", 3}}, {0, {}}}}};
+}
+
+void check_decode_arena() {
+    namespace ship = eosio::ship_protocol;
+    auto action = make_sample_action();
+    action.console = std::string(100, 'c');
+    auto traces = make_sample_traces(20, action);
+    auto bin = eosio::convert_to_bin(traces);
+
+    eosio::decode_arena arena{256};
+    for (int round = 0; round < 3; ++round) {
+        eosio::input_stream stream{bin};
+        auto decoded = eosio::from_bin_in_arena<eosio::arena_vector<ship::arena::transaction_trace>>(arena, stream);
+        if (stream.remaining() || eosio::convert_to_bin(decoded) != bin ||
+            eosio::convert_to_json(decoded) != eosio::convert_to_json(traces))
+            throw std::runtime_error("decode_arena round trip");
+        auto& first = std::get<0>(decoded[0]);
+        auto& nested = std::get<0>(first.failed_dtrx_trace[0].recurse);
+        auto& nested_action = std::get<1>(nested.action_traces[0]);
+        if (decoded.get_allocator().arena != &arena || first.action_traces.get_allocator().arena != &arena ||
+            nested_action.console.get_allocator().arena != &arena || nested_action.except->get_allocator().arena != &arena)
+            throw std::runtime_error("decode_arena allocator not propagated");
+        // Copies made outside the scope live on the heap, so they survive reset()
+        eosio::arena_string copy = nested_action.console;
+        if (copy.get_allocator().arena)
+            throw std::runtime_error("decode_arena copy");
+        size_t capacity = arena.capacity();
+        decoded.clear();
+        arena.reset();
+        if (round && arena.capacity() != capacity)
+            throw std::runtime_error("decode_arena grew after reset");
+    }
+
+    for (bool v1 : {false, true}) {
+        auto block = make_sample_block(v1);
+        auto block_bin = eosio::convert_to_bin(block);
+        eosio::input_stream block_stream{block_bin};
+        auto decoded = eosio::from_bin_in_arena<ship::arena::signed_block_variant>(arena, block_stream);
+        if (block_stream.remaining() || eosio::convert_to_bin(decoded) != block_bin ||
+            eosio::convert_to_json(decoded) != eosio::convert_to_json(block))
+            throw std::runtime_error("decode_arena block round trip");
+    }
+    auto deltas = make_sample_deltas();
+    auto deltas_bin = eosio::convert_to_bin(deltas);
+    eosio::input_stream deltas_stream{deltas_bin};
+    auto decoded_deltas = eosio::from_bin_in_arena<eosio::arena_vector<ship::arena::table_delta>>(arena, deltas_stream);
+    if (deltas_stream.remaining() || eosio::convert_to_bin(decoded_deltas) != deltas_bin ||
+        eosio::convert_to_json(decoded_deltas) != eosio::convert_to_json(deltas))
+        throw std::runtime_error("decode_arena deltas round trip");
+}
+
+void check_ship_views() {
+    namespace ship = eosio::ship_protocol;
+    auto traces = make_sample_traces(3);
+    auto bin = eosio::convert_to_bin(traces);
+
+    eosio::input_stream stream{bin};
+    eosio::sequence_view<ship::view::transaction_trace> view;
+    eosio::from_bin(view, stream);
+    if (stream.remaining() || view.size() != 3 || eosio::convert_to_bin(view) != bin ||
+        eosio::convert_to_json(view) != eosio::convert_to_json(traces))
+        throw std::runtime_error("ship view round trip");
+    for (bool v1 : {false, true}) {
+        auto block = make_sample_block(v1);
+        auto block_bin = eosio::convert_to_bin(block);
+        eosio::input_stream block_stream{block_bin};
+        ship::view::signed_block_variant block_view;
+        eosio::from_bin(block_view, block_stream);
+        if (block_stream.remaining() || eosio::convert_to_bin(block_view) != block_bin ||
+            eosio::convert_to_json(block_view) != eosio::convert_to_json(block))
+            throw std::runtime_error("ship block view round trip");
+    }
+    auto deltas = make_sample_deltas();
+    auto deltas_bin = eosio::convert_to_bin(deltas);
+    eosio::input_stream deltas_stream{deltas_bin};
+    eosio::sequence_view<ship::view::table_delta> deltas_view;
+    eosio::from_bin(deltas_view, deltas_stream);
+    if (deltas_stream.remaining() || deltas_view.size() != 2 || eosio::convert_to_bin(deltas_view) != deltas_bin ||
+        eosio::convert_to_json(deltas_view) != eosio::convert_to_json(deltas) ||
+        std::get<1>(*++deltas_view.begin()).name != "contract_row")
+        throw std::runtime_error("ship delta view round trip");
+    size_t actions = 0;
+    for (auto& t : view) {
+        for (auto& a : std::get<0>(t).action_traces) {
+            auto& console = std::get<1>(a).console;
+            if (console != "hello" || console.data() < bin.data() || console.data() >= bin.data() + bin.size())
+                throw std::runtime_error("ship view does not point into the buffer");
+            ++actions;
+        }
+    }
+    if (actions != 6)
+        throw std::runtime_error("ship view iteration");
+
+    ship::permission_v0 permission{eosio::name{"alice"}, eosio::name{"active"}, eosio::name{"owner"}};
+    permission.auth.threshold = 1;
+    permission.auth.waits = {{10, 1}, {20, 1}};
+    auto permission_bin = eosio::convert_to_bin(ship::permission{permission});
+    eosio::input_stream permission_stream{permission_bin};
+    ship::view::permission permission_view;
+    eosio::from_bin(permission_view, permission_stream);
+    if (eosio::convert_to_json(permission_view) != eosio::convert_to_json(ship::permission{permission}) ||
+        std::get<0>(permission_view).auth.waits.to_vector().size() != 2)
+        throw std::runtime_error("ship permission view");
+
+    auto truncated = bin;
+    truncated.pop_back();
+    eosio::input_stream truncated_stream{truncated};
+    check_throws("Stream overrun", [&] { eosio::from_bin(view, truncated_stream); });
+}
+
+void check_skip_fields() {
+    namespace ship = eosio::ship_protocol;
+    auto traces = make_sample_traces(2);
+    auto bin = eosio::convert_to_bin(traces);
+
+    using skip = eosio::skip_fields<&ship::action_trace_v1::console, &ship::action_trace_v1::account_disk_deltas,
+                                    &ship::action_trace_v1::return_value>;
+    eosio::input_stream stream{bin};
+    std::vector<ship::transaction_trace> decoded;
+    eosio::from_bin(decoded, stream, skip{});
+    if (stream.remaining())
+        throw std::runtime_error("skip_fields did not consume the traces");
+    auto action = make_sample_action();
+    action.console.clear();
+    action.account_disk_deltas.clear();
+    action.return_value = {};
+    if (eosio::convert_to_json(decoded) != eosio::convert_to_json(make_sample_traces(2, action)))
+        throw std::runtime_error("skip_fields decoded the wrong members");
+
+    ship::signed_block_v1 block;
+    block.producer = eosio::name{"bob"};
+    ship::packed_transaction trx;
+    trx.prunable_data.prunable_data = ship::prunable_data_full_legacy{{eosio::signature{}}, eosio::input_stream{"cfd", 3}};
+    trx.packed_trx = eosio::input_stream{"trx", 3};
+    block.transactions.push_back({{}, trx});
+    auto block_bin = eosio::convert_to_bin(ship::signed_block_variant{block});
+    eosio::input_stream block_stream{block_bin};
+    ship::signed_block_variant partial;
+    eosio::from_bin(partial, block_stream,
+                    eosio::skip_fields<&ship::signed_block_header::producer_signature,
+                                       &ship::packed_transaction::prunable_data>{});
+    auto& partial_trx = std::get<ship::packed_transaction>(std::get<1>(partial).transactions[0].trx);
+    if (block_stream.remaining() || std::get<1>(partial).producer != block.producer ||
+        partial_trx.packed_trx.remaining() != 3 ||
+        !std::get<ship::prunable_data_full_legacy>(partial_trx.prunable_data.prunable_data).signatures.empty())
+        throw std::runtime_error("skip_fields block");
+
+    for (auto* b : {&bin, &block_bin}) {
+        eosio::input_stream skipped{*b};
+        if (b == &bin)
+            eosio::skip_bin<std::vector<ship::transaction_trace>>(skipped);
+        else
+            eosio::skip_bin<ship::signed_block_variant>(skipped);
+        if (skipped.remaining())
+            throw std::runtime_error("skip_bin");
+    }
+    auto truncated = bin;
+    truncated.pop_back();
+    eosio::input_stream truncated_stream{truncated};
+    check_throws("Stream overrun", [&] { eosio::skip_bin<std::vector<ship::transaction_trace>>(truncated_stream); });
+}
+
+void check_blocks_result_decoder() {
+    namespace ship = eosio::ship_protocol;
+    auto to_json = [](const ship::decoded_blocks_result& r) {
+        return eosio::convert_to_json(r.this_block) + eosio::convert_to_json(r.block) +
+               eosio::convert_to_json(r.block_header) + eosio::convert_to_json(r.traces) +
+               eosio::convert_to_json(r.deltas);
+    };
+    std::vector<std::vector<char>> messages;
+    std::vector<std::string> expected;
+    for (uint32_t i = 0; i < 60; ++i) {
+        ship::signed_block_v0 block_v0;
+        block_v0.producer = eosio::name{i};
+        ship::signed_block_v1 block_v1;
+        block_v1.producer = eosio::name{i};
+        block_v1.prune_state = 1;
+        ship::action_trace_v1 action;
+        action.console = std::to_string(i);
+        ship::transaction_trace_v0 trace;
+        trace.action_traces.assign(i % 5, action);
+        std::vector<ship::transaction_trace> traces(i % 3, trace);
+        std::vector<ship::table_delta> deltas(i % 4, ship::table_delta_v0{"t" + std::to_string(i), {}});
+        auto traces_bin = eosio::convert_to_bin(traces);
+        auto deltas_bin = eosio::convert_to_bin(deltas);
+        if (i == 44)
+            traces_bin.push_back(0);
+
+        ship::decoded_blocks_result want;
+        want.this_block = ship::block_position{i};
+        want.traces = traces;
+        want.deltas = deltas;
+        ship::result r;
+        if (i % 3 == 0) {
+            ship::get_blocks_result_v0 v0;
+            v0.this_block = want.this_block;
+            auto block_bin = eosio::convert_to_bin(block_v0);
+            v0.block = eosio::input_stream{block_bin};
+            if (!traces.empty())
+                v0.traces = eosio::input_stream{traces_bin};
+            if (!deltas.empty())
+                v0.deltas = eosio::input_stream{deltas_bin};
+            want.block = block_v0;
+            messages.push_back(eosio::convert_to_bin(ship::result{v0}));
+        } else if (i % 3 == 1) {
+            ship::get_blocks_result_v1 v1;
+            v1.this_block = want.this_block;
+            if (i % 2)
+                v1.block = want.block = block_v1;
+            v1.traces = eosio::opaque<std::vector<ship::transaction_trace>>{traces_bin};
+            v1.deltas = eosio::opaque<std::vector<ship::table_delta>>{deltas_bin};
+            messages.push_back(eosio::convert_to_bin(ship::result{v1}));
+        } else {
+            ship::get_blocks_result_v2 v2;
+            v2.this_block = want.this_block;
+            auto block_bin = eosio::convert_to_bin(ship::signed_block_variant{block_v1});
+            auto header_bin = eosio::convert_to_bin(ship::signed_block_header{block_v1});
+            v2.block = eosio::opaque<ship::signed_block_variant>{block_bin};
+            v2.block_header = eosio::opaque<ship::signed_block_header>{header_bin};
+            v2.traces = eosio::opaque<std::vector<ship::transaction_trace>>{traces_bin};
+            v2.deltas = eosio::opaque<std::vector<ship::table_delta>>{deltas_bin};
+            want.block = block_v1;
+            want.block_header = block_v1;
+            messages.push_back(eosio::convert_to_bin(ship::result{v2}));
+        }
+        expected.push_back(to_json(want));
+    }
+    messages[7].resize(messages[7].size() - 1);
+    messages[31] = eosio::convert_to_bin(ship::result{ship::get_status_result_v0{}});
+    messages[52].push_back(0);
+
+    ship::blocks_result_decoder decoder{4, 8};
+    std::thread producer([&] {
+        for (auto& m : messages)
+            decoder.push(m);
+        decoder.finish();
+    });
+    size_t n = 0;
+    while (true) {
+        ship::decoded_blocks_result result;
+        if (n == 7 || n == 31 || n == 44 || n == 52) {
+            check_throws(n == 7    ? "Stream overrun"
+                         : n == 31 ? "not a get_blocks_result"
+                                   : "extra data in get_blocks_result",
+                         [&] { decoder.pop(result); });
+            ++n;
+            continue;
+        }
+        if (!decoder.pop(result))
+            break;
+        if (to_json(result) != expected[n])
+            throw std::runtime_error("blocks_result_decoder message " + std::to_string(n));
+        ++n;
+    }
+    producer.join();
+    if (n != messages.size())
+        throw std::runtime_error("blocks_result_decoder lost messages");
+}
+
+void check_table_delta_decoder() {
+    namespace ship = eosio::ship_protocol;
+    constexpr size_t num_tables = std::variant_size_v<ship::table_row>;
+    for (size_t i = 0; i < num_tables; ++i) {
+        eosio::dispatch_index<num_tables>(i, [&](auto n) {
+            using T = std::variant_alternative_t<decltype(n)::value, ship::table_row>;
+            if (ship::table_row_index(ship::get_type_name((T*)nullptr)) != int(i))
+                throw std::runtime_error("table_row_index");
+        });
+    }
+    if (ship::table_row_index("contract_rows") != -1 || ship::table_row_index("") != -1 || ship::table_row_index("x") != -1 ||
+        ship::table_row_index("block_header") != -1)
+        throw std::runtime_error("table_row_index accepted an unknown name");
+
+    std::vector<std::vector<char>> storage;
+    ship::table_delta_v1 rows{"contract_row"};
+    for (uint64_t i = 0; i < 1000; ++i) {
+        storage.push_back(eosio::convert_to_bin(ship::contract_row{
+            ship::contract_row_v0{eosio::name{"eosio"}, eosio::name{i}, eosio::name{"accounts"}, i}}));
+        rows.rows.push_back({uint8_t(i % 3), eosio::input_stream{storage.back()}});
+    }
+    std::vector<ship::table_delta> deltas{rows};
+    storage.push_back(eosio::convert_to_bin(ship::permission{ship::permission_v0{eosio::name{"alice"}, eosio::name{"active"}}}));
+    deltas.push_back(ship::table_delta_v0{"permission", {{true, eosio::input_stream{storage.back()}}, {false, {}}}});
+
+    eosio::worker_pool pool{3};
+    for (auto* p : {(eosio::worker_pool*)nullptr, &pool}) {
+        auto typed = ship::decode_table_deltas(deltas, p, 64);
+        auto json = ship::decode_table_deltas<std::string>(deltas, p, 64);
+        if (typed.size() != 2 || typed[0].name != "contract_row" || typed[0].rows.size() != 1000 ||
+            typed[1].name != "permission" || typed[1].rows.size() != 2 || typed[1].rows[1].present)
+            throw std::runtime_error("decode_table_deltas shape");
+        for (size_t i = 0; i < 1000; ++i) {
+            auto& row = std::get<ship::contract_row_v0>(std::get<ship::contract_row>(typed[0].rows[i].data));
+            if (typed[0].rows[i].present != i % 3 || row.primary_key != i || row.scope != eosio::name{i} ||
+                json[0].rows[i].data != eosio::convert_to_json(std::get<ship::contract_row>(typed[0].rows[i].data)))
+                throw std::runtime_error("decode_table_deltas row " + std::to_string(i));
+        }
+        if (std::get<ship::permission_v0>(std::get<ship::permission>(typed[1].rows[0].data)).owner != eosio::name{"alice"})
+            throw std::runtime_error("decode_table_deltas permission");
+    }
+
+    check_throws("rows_per_job must be positive", [&] { ship::decode_table_deltas(deltas, nullptr, 0); });
+    deltas.push_back(ship::table_delta_v0{"no_such_table"});
+    check_throws("unknown table_delta name: no_such_table", [&] { ship::decode_table_deltas(deltas, &pool); });
+    deltas.pop_back();
+    auto bad = eosio::convert_to_bin(ship::contract_row{});
+    bad.pop_back();
+    std::get<ship::table_delta_v1>(deltas[0]).rows[500].data = eosio::input_stream{bad};
+    check_throws("Stream overrun", [&] { ship::decode_table_deltas(deltas, &pool, 64); });
+    auto extra = eosio::convert_to_bin(ship::contract_row{});
+    extra.push_back(0);
+    std::get<ship::table_delta_v1>(deltas[0]).rows[500].data = eosio::input_stream{extra};
+    check_throws("extra data in table_delta row", [&] { ship::decode_table_deltas(deltas, &pool, 64); });
+}
+
+void check_trace_cursor() {
+    namespace ship = eosio::ship_protocol;
+    // Transactions with 0 to 3 actions, mixing action_trace_v0 and v1
+    auto traces = make_sample_traces(6);
+    for (uint32_t t = 0; t < traces.size(); ++t) {
+        auto& trace = std::get<0>(traces[t]);
+        trace.id = eosio::checksum256{std::array<uint8_t, 32>{uint8_t(t)}};
+        trace.cpu_usage_us = t;
+        trace.action_traces.resize(std::min(t % 4, 2u));
+        for (uint32_t a = 0; a < trace.action_traces.size(); ++a) {
+            auto& action = std::get<ship::action_trace_v1>(trace.action_traces[a]);
+            action.receiver = eosio::name{t * 10 + a};
+            action.console = std::string(a * 3, 'x');
+        }
+        if (t % 4 == 3)
+            trace.action_traces.push_back(ship::action_trace_v0{{}, {}, {}, eosio::name{t * 10 + 2}});
+    }
+    auto bin = eosio::convert_to_bin(traces);
+
+    auto expect = [&](auto& cursor, bool skip_third) {
+        size_t n = 0;
+        for (uint32_t t = 0; t < traces.size(); ++t) {
+            auto& trace = std::get<0>(traces[t]);
+            for (uint32_t a = 0; a < trace.action_traces.size(); ++a) {
+                if (skip_third && t == 3 && a == 1) {
+                    cursor.skip_transaction();
+                    break;
+                }
+                if (!cursor.next() || cursor.transaction_index() != t || cursor.action_index() != a ||
+                    cursor.transaction().id != trace.id || cursor.transaction().cpu_usage_us != t ||
+                    eosio::convert_to_json(cursor.action()) != eosio::convert_to_json(trace.action_traces[a]))
+                    throw std::runtime_error("trace_cursor action " + std::to_string(n));
+                ++n;
+            }
+        }
+        if (cursor.next() || cursor.next())
+            throw std::runtime_error("trace_cursor did not end");
+    };
+    ship::trace_cursor view_cursor{eosio::input_stream{bin}};
+    expect(view_cursor, false);
+    ship::basic_trace_cursor<ship::action_trace> cursor{eosio::input_stream{bin}};
+    expect(cursor, false);
+    ship::trace_cursor skipping{eosio::input_stream{bin}};
+    expect(skipping, true);
+
+    ship::trace_cursor first{eosio::input_stream{bin}};
+    if (!first.next() || std::get<ship::view::action_trace_v1>(first.action()).console.data() < bin.data() ||
+        std::get<ship::view::action_trace_v1>(first.action()).console.data() > bin.data() + bin.size())
+        throw std::runtime_error("trace_cursor view does not point into the buffer");
+
+    auto truncated = bin;
+    truncated.pop_back();
+    ship::trace_cursor bad{eosio::input_stream{truncated}};
+    check_throws("Stream overrun", [&] {
+        while (bad.next()) {}
+    });
+    auto padded = bin;
+    padded.push_back(0);
+    ship::trace_cursor extra{eosio::input_stream{padded}};
+    check_throws("extra data in transaction traces", [&] {
+        while (extra.next()) {}
+    });
+}
+
+void check_json_to_bin_push() {
+    abieos::abi abi{std::string{R"({
+        "version": "eosio::abi/1.1",
+        "structs": [
+            {"name": "s", "base": "", "fields": [{"name": "a", "type": "int8[]"}, {"name": "n", "type": "name"}]},
+            {"name": "t", "base": "", "fields": [
+                {"name": "x", "type": "s[2]"}, {"name": "o", "type": "string?"}, {"name": "v", "type": "var"},
+                {"name": "l", "type": "s[]"}, {"name": "e", "type": "uint32$"}]}
+        ],
+        "variants": [{"name": "var", "types": ["int8", "s", "string"]}]
+    })"}};
+
+    // Feeds json in pieces of every size from 1 to the whole document; the result must match json_to_bin
+    auto check_pieces = [&](const char* type, std::string json, const char* expected_hex) {
+        auto t = abi.get_type(type);
+        std::string hex;
+        try {
+            auto bin = t->json_to_bin(json);
+            abieos::hex(bin.begin(), bin.end(), std::back_inserter(hex));
+        } catch (std::exception&) {
+        }
+        if (hex != expected_hex)
+            throw std::runtime_error("json_to_bin mismatch: " + hex);
+        for (size_t piece = 1; piece <= json.size(); ++piece) {
+            std::vector<char> bin;
+            std::string push_hex;
+            try {
+                abieos::json_to_bin_push_parser parser(bin, t);
+                for (size_t pos = 0; pos < json.size(); pos += piece)
+                    parser.feed(json.data() + pos, std::min(piece, json.size() - pos));
+                parser.finish();
+                abieos::hex(bin.begin(), bin.end(), std::back_inserter(push_hex));
+            } catch (std::exception&) {
+            }
+            if (push_hex != expected_hex)
+                throw std::runtime_error("json_to_bin_push_parser mismatch: " + push_hex);
+        }
+    };
+
+    check_pieces("s[2]", R"([{"a":[1],"n":""},{"a":[2,3],"n":""}])", "01010000000000000000020203" "0000000000000000");
+    check_pieces("t",
+                 R"( {"x":[{"a":[],"n":"a"},{"a":[-1],"n":"b"}],"o":"q\"\\","v":["s",{"a":[4],"n":""}],)"
+                 R"("l":[{"a":[5,6],"n":""}],"e":7} )",
+                 "000000000000000030" "01FF0000000000000038" "010371225C" "01010400000000000000000102050600000000000000"
+                 "0007000000");
+    check_pieces("t", R"({"x":[{"a":[],"n":""},{"a":[],"n":""}],"o":null,"v":["int8",1],"l":[]})",
+                 "000000000000000000" "00000000000000000000" "0001" "00");
+    check_pieces("t", R"({"x":[{"a":[],"n":""},{"a":[],"n":""}],"o":null,"v":["int8",1],"l":[]} x)", "");
+    check_pieces("t", R"({"x":[{"a":[],"n":""},{"a":[],"n":""}],"o":null,"v":["int8",1],"l":[])", "");
+    check_pieces("t", R"({"x":[{"a":[1 2],"n":""}]})", "");
+    check_pieces("int8[]", "[1,\n2\t,3\r]", "03010203");
+    check_pieces("int8", "12", "0C");
+    check_pieces("int8", "1x", "");
+    check_pieces("int8", "", "");
+
+    // Binary ahead of an open array is passed on before the document is complete
+    std::vector<char> bin;
+    abieos::json_to_bin_push_parser parser(bin, abi.get_type("t"));
+    std::string json = R"({"x":[{"a":[],"n":""},{"a":[],"n":""}],"o":"abc","v":["int8",1],"l":[{"a":[1,2],)";
+    parser.feed(json.data(), json.size());
+    if (bin.size() != 25)
+        throw std::runtime_error("json_to_bin_push_parser did not flush");
+}
+
 int main() {
     try {
         check_types();
         printf("\ncheck_types ok\n\n");
 
+        check_json_to_bin_push();
+        printf("\ncheck_json_to_bin_push ok\n\n");
+
+        check_segmented_stream();
+        printf("\ncheck_segmented_stream ok\n\n");
+
+        check_convert_modes();
+        printf("\ncheck_convert_modes ok\n\n");
+
+        check_fd_stream();
+        printf("\ncheck_fd_stream ok\n\n");
+
+        check_decode_arena();
+        printf("\ncheck_decode_arena ok\n\n");
+
+        check_ship_views();
+        printf("\ncheck_ship_views ok\n\n");
+
+        check_skip_fields();
+        printf("\ncheck_skip_fields ok\n\n");
+
+        check_blocks_result_decoder();
+        printf("\ncheck_blocks_result_decoder ok\n\n");
+
+        check_table_delta_decoder();
+        printf("\ncheck_table_delta_decoder ok\n\n");
+
+        check_trace_cursor();
+        printf("\ncheck_trace_cursor ok\n\n");
+
         test_abi_kv_table();
         printf("\ntest_abi_kv_table: ok\n\n");
         return 0;